@@ -0,0 +1,89 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Benchmark of the box overlap kernels
+*/
+
+#include "BoxBatch.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using cevy::engine::AABB;
+using cevy::engine::Vector;
+using cevy::physics::BoxArrays;
+using cevy::physics::Broadphase;
+namespace batch = cevy::physics::batch;
+
+using Kernel = size_t (*)(const BoxArrays &, const Broadphase::Pair *, size_t,
+                          Broadphase::Pair *);
+
+/* nanoseconds per pair, best of the runs */
+static double measure(Kernel kernel, const BoxArrays &boxes,
+                      const std::vector<Broadphase::Pair> &pairs,
+                      std::vector<Broadphase::Pair> &out, size_t &kept) {
+  double best = 1e30;
+
+  for (size_t run = 0; run < 50; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    kept = kernel(boxes, pairs.data(), pairs.size(), out.data());
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    best = std::min(best, elapsed.count() / pairs.size());
+  }
+  return best;
+}
+
+/*
+ * Usage: bench-overlap [boxes] [pairs per box]
+ * Candidate pairs link each box to its neighbours in a grid, as a broadphase would,
+ * about a third of them overlap.
+ */
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  size_t neighbours = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 16;
+  std::mt19937 random(42);
+  std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+  std::uniform_real_distribution<float> size(0.5f, 1.5f);
+  /* the box after, and the three above in the grid */
+  size_t offsets[] = {1, 99, 100, 101};
+  std::uniform_int_distribution<size_t> offset(0, 3);
+  BoxArrays boxes;
+  std::vector<Broadphase::Pair> pairs;
+
+  for (size_t i = 0; i < count; ++i) {
+    Vector min(float(i % 100) + jitter(random), float(i / 100 % 100) + jitter(random),
+               jitter(random));
+
+    boxes.set(i, AABB(min, min + Vector(size(random), size(random), size(random))));
+  }
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t n = 0; n < neighbours; ++n) {
+      size_t other = (i + offsets[offset(random)]) % count;
+
+      pairs.emplace_back(std::min(i, other), std::max(i, other));
+    }
+  }
+
+  std::vector<Broadphase::Pair> scalar_out(pairs.size());
+  std::vector<Broadphase::Pair> batch_out(pairs.size());
+  size_t scalar_kept = 0;
+  size_t batch_kept = 0;
+  double scalar = measure(batch::overlapping_scalar, boxes, pairs, scalar_out, scalar_kept);
+  double simd = measure(batch::overlapping, boxes, pairs, batch_out, batch_kept);
+
+  scalar_out.resize(scalar_kept);
+  batch_out.resize(batch_kept);
+  if (scalar_out != batch_out) {
+    std::printf("the kernels disagree\n");
+    return 1;
+  }
+  std::printf("%zu pairs, %zu overlapping\n", pairs.size(), scalar_kept);
+  std::printf("scalar: %.2f ns/pair\n", scalar);
+  std::printf("batch:  %.2f ns/pair (x%.2f)\n", simd, scalar / simd);
+  return 0;
+}
@@ -0,0 +1,167 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** System data access
+*/
+
+#pragma once
+
+#include <set>
+#include <type_traits>
+#include <typeindex>
+
+#include "Budget.hpp"
+#include "Event.hpp"
+#include "Query.hpp"
+#include "Resource.hpp"
+#include "World.hpp"
+#include "ecs.hpp"
+
+namespace cevy::ecs {
+/**
+ * @brief The world data a system reads and writes, deduced from its parameters
+ *
+ * Two systems of a same stage whose accesses conflict are never run at the same time,
+ * and keep their registration order.
+ *
+ * - Query<T...>: writes every queried component
+ * - Resource<R> and std::optional<Resource<R>>: writes R
+ * - EventReader<T>: reads Event<T>, EventWriter<T>: writes Event<T>
+ * - Budget: nothing, its state belongs to the system
+ * - Commands: reads the entity list, its command buffer belongs to the system
+ * - const World &: reads everything
+ * - World &: exclusive, the system runs alone on the main thread
+ */
+class Access {
+  public:
+  Access() = default;
+
+  /// Access of a system taking all of Params
+  template <typename... Params>
+  static Access of() {
+    Access access;
+    (access.add_param<Params>(), ...);
+    return access;
+  }
+
+  /// Access of a system that may touch anything in the world
+  static Access exclusive() {
+    Access access;
+    access._exclusive = true;
+    return access;
+  }
+
+  /// Access of a system that may read anything in the world
+  static Access read_all() {
+    Access access;
+    access._read_all = true;
+    return access;
+  }
+
+  template <typename T>
+  Access &read() {
+    _reads.insert(std::type_index(typeid(T)));
+    return *this;
+  }
+
+  template <typename T>
+  Access &write() {
+    _writes.insert(std::type_index(typeid(T)));
+    return *this;
+  }
+
+  /// Mark a piece of state shared outside of the world, e.g. by a run condition
+  Access &write_state(const void *state) {
+    _states.insert(state);
+    return *this;
+  }
+
+  void merge(const Access &other) {
+    _reads.insert(other._reads.begin(), other._reads.end());
+    _writes.insert(other._writes.begin(), other._writes.end());
+    _states.insert(other._states.begin(), other._states.end());
+    _read_all = _read_all || other._read_all;
+    _exclusive = _exclusive || other._exclusive;
+  }
+
+  /// true if the two accesses cannot run at the same time
+  bool conflicts(const Access &other) const {
+    if (_exclusive || other._exclusive) {
+      return true;
+    }
+    if ((_read_all && other.writes_any()) || (other._read_all && writes_any())) {
+      return true;
+    }
+    for (const auto &state : _states) {
+      if (other._states.count(state)) {
+        return true;
+      }
+    }
+    for (const auto &type : _writes) {
+      if (other._writes.count(type) || other._reads.count(type)) {
+        return true;
+      }
+    }
+    for (const auto &type : other._writes) {
+      if (_reads.count(type)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool is_exclusive() const { return _exclusive; }
+
+  protected:
+  template <typename Q>
+  struct query_access;
+
+  template <typename... T>
+  struct query_access<Query<T...>> {
+    static void apply(Access &access) { (access.add_query_term<remove_optional<T>>(), ...); }
+  };
+
+  template <typename T>
+  void add_query_term() {
+    if constexpr (std::is_same_v<T, Entity>) {
+      read<Entity>();
+    } else {
+      write<T>();
+    }
+  }
+
+  template <typename P>
+  void add_param() {
+    if constexpr (std::is_same_v<P, const World &>) {
+      _read_all = true;
+    } else if constexpr (is_world<P>::value) {
+      _exclusive = true;
+    } else if constexpr (is_commands<P>::value) {
+      read<Entity>();
+    } else if constexpr (is_query<P>::value) {
+      query_access<P>::apply(*this);
+    } else if constexpr (is_resource<P>::value && is_optional<P>::value) {
+      write<typename P::value_type::value>();
+    } else if constexpr (is_resource<P>::value) {
+      write<typename P::value>();
+    } else if constexpr (is_event_reader<P>::value) {
+      read<Event<typename P::value_type>>();
+    } else if constexpr (is_event_writer<P>::value) {
+      write<Event<typename P::value_type>>();
+    } else if constexpr (is_budget<P>::value) {
+      return;
+    } else {
+      _exclusive = true;
+    }
+  }
+
+  bool writes_any() const { return _exclusive || !_writes.empty(); }
+
+  std::set<std::type_index> _reads;
+  std::set<std::type_index> _writes;
+  std::set<const void *> _states;
+  bool _read_all = false;
+  bool _exclusive = false;
+};
+} // namespace cevy::ecs
@@ -114,26 +114,33 @@ class cevy::ecs::App : public cevy::ecs::World {
    * this command will raise a warning and won't do anything until Update is instanciated
    *
    * @tparam System Could be any thing that have the Operator `()` implemented
+   * @return SystemConfig to further configure the added systems, e.g. with run conditions
    */
   template <class... System>
-  void add_systems(System &&...system) {
-    (_scheduler.add_system(std::forward<System>(system)), ...);
+  SystemConfig add_systems(System &&...system) {
+    return SystemConfig(_scheduler, {_scheduler.add_system(std::forward<System>(system))...});
   }
 
   /**
    * @brief Move one or multiple systems to the given schedule in this app’s \link
    * cevy::ecs::Scheduler Schedules\endlink.
    *
+   * '''
+   * app.add_systems<core_stage::Update>(on_hit).run_if(condition::on_event<Hit>());
+   * '''
+   *
    * @tparam System Could be any thing that have the Operator `()` implemented
+   * @return SystemConfig to further configure the added systems, e.g. with run conditions
    */
   template <class Stage, class... System>
-  void add_systems(System &&...system) {
-    (_scheduler.add_system<Stage>(std::forward<System>(system)), ...);
+  SystemConfig add_systems(System &&...system) {
+    return SystemConfig(_scheduler,
+                        {_scheduler.add_system<Stage>(std::forward<System>(system))...});
   }
 
   template <class F, class S, class... Args>
-  void add_class_system(const F &func) {
-    _scheduler.add_class_system<F, S, Args...>(func);
+  SystemConfig add_class_system(const F &func) {
+    return SystemConfig(_scheduler, {_scheduler.add_class_system<F, S, Args...>(func)});
   }
 
   /**
@@ -141,14 +148,38 @@ class cevy::ecs::App : public cevy::ecs::World {
    *
    * This is done by adding a Resource of type @link Events Events<T>@endlink
    * @tparam T Type serving as event, All are supported
-   * @warning C++evy implementation differs from `Bevy` one's where
-   * we don't define a event_update_system into First,
-   * the event queue cleaning is done when the event reach it's EventWriter again,
-   * supporting multiple EventWriter
+   * Like in `Bevy`, a system updating the event queue is added to First:
+   * an event can be read during the frame it is sent and the next one,
+   * each EventReader reads it once.
    * See Events for defining events.
    */
   template <typename T>
   void add_event() {
+    if (contains_resource<Event<T>>()) {
+      return;
+    }
     insert_resource(Event<T>());
+    add_systems<core_stage::First>(update_events<T>);
+  }
+
+  /**
+   * @brief Thread-safe handle to send events of type T from outside of the systems
+   *
+   * Events are pushed into a bounded lock-free channel, then added to the event queue
+   * when it is updated, at the start of core_stage::First.
+   * Registers the event if needed. Call it during setup, before run():
+   * the capacity is only used by the first call.
+   */
+  template <typename T>
+  EventSender<T> event_sender(size_t capacity = EventChannel<T>::default_capacity) {
+    add_event<T>();
+    return resource<Event<T>>().sender(capacity);
+  }
+
+  protected:
+  /// Swap the buffers of the event queue of T, once per frame
+  template <typename T>
+  static void update_events(Resource<Event<T>> events) {
+    events->update();
   }
 };
@@ -0,0 +1,163 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Budgeted systems
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+
+#include "Query.hpp"
+#include "ecs.hpp"
+
+namespace cevy::ecs {
+/**
+ * @brief Persistent state of a budgeted system, kept by the Scheduler between frames
+ *
+ * The limits are set with SystemConfig::with_budget, the other fields report
+ * what the system did during its last run.
+ */
+struct BudgetState {
+  using clock = std::chrono::steady_clock;
+
+  /// maximum run time per frame, unlimited if not set
+  std::optional<std::chrono::duration<double, std::milli>> time = std::nullopt;
+  /// maximum number of items per frame, unlimited if not set
+  std::optional<size_t> items = std::nullopt;
+
+  /// where the work resumes next frame
+  size_t cursor = 0;
+  /// number of passes completed since the start
+  size_t passes = 0;
+  /// true if the last run completed a pass
+  bool completed = false;
+  /// number of items processed by the last run
+  size_t used_items = 0;
+  /// true if the last run stopped because of the budget
+  bool exhausted = false;
+};
+
+/**
+ * @brief System parameter spreading a long job over multiple frames
+ *
+ * The system processes items from the cursor until the budget of the frame is spent,
+ * the cursor is kept by the Scheduler and the work resumes there next frame.
+ * '''
+ * void replan(Query<Entity, Agent> agents, Budget budget) {
+ *   budget.for_each(agents, [](auto item) { ... });
+ * }
+ *
+ * app.add_systems<core_stage::Update>(replan).with_budget(std::chrono::milliseconds(2), 5000);
+ * '''
+ * The clock is only read every few items, a single item should stay well under the time limit.
+ */
+class Budget {
+  public:
+  using clock = BudgetState::clock;
+  static constexpr size_t clock_stride = 16;
+
+  Budget(BudgetState &state) : _state(state), _begin(clock::now()) {
+    _state.completed = false;
+    _state.exhausted = false;
+    _state.used_items = 0;
+  }
+
+  /// Where the work left off
+  size_t cursor() const { return _state.cursor; }
+
+  /// Move the cursor forward
+  void advance(size_t n = 1) { _state.cursor += n; }
+
+  /// Place the cursor, e.g. on the slot of the next entity to process
+  void set_cursor(size_t cursor) { _state.cursor = cursor; }
+
+  /**
+   * @brief Consume items from the budget of this frame
+   *
+   * @return false if the budget is spent, the items should not be processed
+   */
+  bool step(size_t items = 1) {
+    if (_state.exhausted) {
+      return false;
+    }
+    if (_state.items && _state.used_items + items > *_state.items) {
+      _state.exhausted = true;
+      return false;
+    }
+    size_t used = _state.used_items;
+    bool check_clock = used / clock_stride != (used + items) / clock_stride;
+    if (_state.time && check_clock && clock::now() - _begin >= *_state.time) {
+      _state.exhausted = true;
+      return false;
+    }
+    _state.used_items += items;
+    return true;
+  }
+
+  /// The pass is over, the next one starts from the beginning
+  void complete() {
+    _state.cursor = 0;
+    _state.passes += 1;
+    _state.completed = true;
+  }
+
+  /// true once the budget of this frame is spent
+  bool exhausted() const { return _state.exhausted; }
+
+  /// Number of completed passes
+  size_t passes() const { return _state.passes; }
+
+  /**
+   * @brief Call func on each index of [cursor, count) while the budget allows it
+   *
+   * @return true if the pass was completed during this call
+   */
+  template <typename F>
+  bool for_range(size_t count, F &&func) {
+    while (_state.cursor < count) {
+      if (!step()) {
+        return false;
+      }
+      func(_state.cursor);
+      _state.cursor += 1;
+    }
+    complete();
+    return true;
+  }
+
+  /**
+   * @brief Call func on each item of the query from the cursor while the budget allows it
+   *
+   * The cursor holds the slot of the next entity, entities spawned or despawned between
+   * frames are picked up or skipped by the next pass.
+   * @return true if the pass was completed during this call
+   */
+  template <typename F, typename... T>
+  bool for_each(Query<T...> &query, F &&func) {
+    for (auto it = query.from(_state.cursor); it != query.end(); ++it) {
+      if (!step()) {
+        _state.cursor = it.index();
+        return false;
+      }
+      func(*it);
+    }
+    complete();
+    return true;
+  }
+
+  protected:
+  BudgetState &_state;
+  clock::time_point _begin;
+};
+} // namespace cevy::ecs
+
+template <class T>
+struct is_budget : public std::false_type {};
+
+template <>
+struct is_budget<cevy::ecs::Budget> : public std::true_type {};
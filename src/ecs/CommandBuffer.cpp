@@ -0,0 +1,219 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Command buffer
+*/
+
+#include "CommandBuffer.hpp"
+#include "World.hpp"
+
+#include <algorithm>
+
+using cevy::ecs::CommandBuffer;
+
+static size_t align_up(size_t offset, size_t align) { return (offset + align - 1) / align * align; }
+
+CommandBuffer::CommandBuffer(CommandBuffer &&rhs) noexcept
+    : _page_size(rhs._page_size), _pages(std::move(rhs._pages)), _current(rhs._current),
+      _count(rhs._count), _batch(std::move(rhs._batch)), _despawned(std::move(rhs._despawned)) {
+  rhs._pages.clear();
+  rhs._current = 0;
+  rhs._count = 0;
+}
+
+CommandBuffer &CommandBuffer::operator=(CommandBuffer &&rhs) noexcept {
+  if (this != &rhs) {
+    clear();
+    _page_size = rhs._page_size;
+    _pages = std::move(rhs._pages);
+    _current = rhs._current;
+    _count = rhs._count;
+    _batch = std::move(rhs._batch);
+    _despawned = std::move(rhs._despawned);
+    rhs._pages.clear();
+    rhs._current = 0;
+    rhs._count = 0;
+  }
+  return *this;
+}
+
+CommandBuffer::~CommandBuffer() { clear(); }
+
+size_t CommandBuffer::capacity() const {
+  size_t total = 0;
+
+  for (const auto &page : _pages) {
+    total += page.size;
+  }
+  return total;
+}
+
+CommandBuffer::Header *CommandBuffer::allocate(size_t size, size_t align) {
+  size_t needed = sizeof(Header) + align + size + alignof(Header);
+
+  if (_pages.empty()) {
+    _pages.push_back(Page {std::make_unique<std::byte[]>(std::max(_page_size, needed)),
+                           std::max(_page_size, needed), 0});
+    _current = 0;
+  }
+  if (_pages[_current].used + needed > _pages[_current].size) {
+    _current += 1;
+    if (_current == _pages.size() || _pages[_current].size < needed) {
+      size_t page_size = std::max(_page_size, needed);
+      _pages.insert(_pages.begin() + _current,
+                    Page {std::make_unique<std::byte[]>(page_size), page_size, 0});
+    }
+  }
+
+  Page &page = _pages[_current];
+  size_t header_offset = align_up(page.used, alignof(Header));
+  size_t payload_offset = align_up(header_offset + sizeof(Header), align);
+  size_t end = align_up(payload_offset + size, alignof(Header));
+  Header *header = reinterpret_cast<Header *>(page.data.get() + header_offset);
+
+  header->meta = noop_meta();
+  header->entity = 0;
+  header->payload = payload_offset - header_offset;
+  header->next = end - header_offset;
+  page.used = end;
+  return header;
+}
+
+bool CommandBuffer::first_record(Position &pos) const {
+  pos = Position {0, 0};
+  return !_pages.empty() && _pages[0].used > 0;
+}
+
+bool CommandBuffer::next_record(Position &pos) const {
+  const Header *header = reinterpret_cast<const Header *>(_pages[pos.page].data.get() + pos.offset);
+
+  pos.offset += header->next;
+  if (pos.offset < _pages[pos.page].used) {
+    return true;
+  }
+  if (pos.page >= _current) {
+    return false;
+  }
+  pos.page += 1;
+  pos.offset = 0;
+  return _pages[pos.page].used > 0;
+}
+
+static bool is_typed(CommandBuffer::Op op) {
+  return op == CommandBuffer::Op::Insert || op == CommandBuffer::Op::Remove;
+}
+
+void CommandBuffer::apply(World &world) {
+  Position pos;
+  bool found = first_record(pos);
+
+  while (found) {
+    Header *header = header_at(pos);
+    Op op = header->meta->op;
+
+    if (op == Op::Custom) {
+      try {
+        header->meta->apply(world, header->entity, payload_of(header));
+      } catch (...) {
+        header->meta->destroy(payload_of(header));
+        if (next_record(pos)) {
+          discard_from(pos);
+        } else {
+          reset();
+        }
+        throw;
+      }
+      header->meta->destroy(payload_of(header));
+      found = next_record(pos);
+      continue;
+    }
+
+    /* gather the following records that can be applied together */
+    _batch.clear();
+    _batch.push_back(header);
+    while ((found = next_record(pos))) {
+      Op next = header_at(pos)->meta->op;
+
+      if (next == Op::Custom || is_typed(next) != is_typed(op)) {
+        break;
+      }
+      _batch.push_back(header_at(pos));
+    }
+    try {
+      apply_batch(world);
+    } catch (...) {
+      destroy_batch();
+      if (found) {
+        discard_from(pos);
+      } else {
+        reset();
+      }
+      throw;
+    }
+    destroy_batch();
+  }
+  reset();
+}
+
+void CommandBuffer::apply_batch(World &world) {
+  if (!is_typed(_batch.front()->meta->op)) {
+    _despawned.clear();
+    for (auto *header : _batch) {
+      _despawned.push_back(header->entity);
+    }
+    std::sort(_despawned.begin(), _despawned.end());
+    _despawned.erase(std::unique(_despawned.begin(), _despawned.end()), _despawned.end());
+    world.despawn_many(_despawned);
+    return;
+  }
+
+  /* the order of the records of a same type is kept, which is all an entity can observe */
+  std::stable_sort(_batch.begin(), _batch.end(), [](const Header *lhs, const Header *rhs) {
+    return lhs->meta->type < rhs->meta->type;
+  });
+  size_t begin = 0;
+  while (begin < _batch.size()) {
+    size_t end = begin + 1;
+
+    while (end < _batch.size() && _batch[end]->meta->type == _batch[begin]->meta->type) {
+      end += 1;
+    }
+    _batch[begin]->meta->apply_typed(world, _batch.data() + begin, end - begin);
+    begin = end;
+  }
+}
+
+void CommandBuffer::destroy_batch() {
+  for (auto *header : _batch) {
+    header->meta->destroy(payload_of(header));
+  }
+  _batch.clear();
+}
+
+void CommandBuffer::clear() {
+  Position pos;
+
+  if (first_record(pos)) {
+    discard_from(pos);
+  }
+}
+
+void CommandBuffer::discard_from(Position pos) {
+  bool found = true;
+
+  while (found) {
+    Header *header = header_at(pos);
+    header->meta->destroy(payload_of(header));
+    found = next_record(pos);
+  }
+  reset();
+}
+
+void CommandBuffer::reset() {
+  for (auto &page : _pages) {
+    page.used = 0;
+  }
+  _current = 0;
+  _count = 0;
+}
@@ -0,0 +1,230 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Command buffer
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+#include "ecs.hpp"
+
+/**
+ * @brief Deferred world operations, stored as typed records in a byte arena
+ *
+ * Each record holds its operation, the entity, the component type and the component itself
+ * (or the callable of a custom command) inline: pushing a command does not allocate
+ * once the arena is warm.
+ * The arena is made of pages that never move, so commands can be pushed while the buffer
+ * is being applied. Applying or clearing the buffer keeps its pages for the next frame.
+ *
+ * Consecutive inserts and removes are applied grouped by component type, with one storage
+ * lookup and one resize per type, and consecutive despawns with one sweep per storage.
+ * Custom commands split the groups, so they see every command pushed before them applied.
+ */
+class cevy::ecs::CommandBuffer {
+  public:
+  enum class Op : uint8_t {
+    Insert,
+    Remove,
+    Despawn,
+    Custom,
+  };
+
+  struct Header;
+
+  /// What a record does, one instance per operation and type
+  struct Meta {
+    Op op;
+    std::type_index type;
+    /// run a custom record
+    void (*apply)(World &world, size_t entity, void *payload);
+    /// apply inserts and removes of this component type, in order
+    void (*apply_typed)(World &world, Header *const *records, size_t count);
+    void (*destroy)(void *payload);
+  };
+
+  static constexpr size_t default_page_size = 64 * 1024;
+
+  CommandBuffer(size_t page_size = default_page_size) : _page_size(page_size) {};
+  CommandBuffer(CommandBuffer &&rhs) noexcept;
+  CommandBuffer &operator=(CommandBuffer &&rhs) noexcept;
+  CommandBuffer(const CommandBuffer &) = delete;
+  CommandBuffer &operator=(const CommandBuffer &) = delete;
+  ~CommandBuffer();
+
+  /// Add or replace the component of an entity
+  template <typename Component>
+  void insert(size_t entity, const Component &component) {
+    push<Component>(insert_meta<Component>(), entity, component);
+  }
+
+  /// Remove a component from an entity
+  template <typename Component>
+  void remove(size_t entity) {
+    push_empty(remove_meta<Component>(), entity);
+  }
+
+  /// Remove an entity and all its components
+  void despawn(size_t entity) { push_empty(despawn_meta(), entity); }
+
+  /// Run func(world) when the buffer is applied
+  template <typename F>
+  void custom(F &&func) {
+    using Func = std::decay_t<F>;
+
+    push<Func>(custom_meta<Func>(), 0, std::forward<F>(func));
+  }
+
+  /// Apply every record in order, then clear the buffer
+  void apply(World &world);
+
+  /// Drop every record without applying them, the memory is kept
+  void clear();
+
+  /// Number of records waiting to be applied
+  size_t size() const { return _count; }
+
+  bool empty() const { return _count == 0; }
+
+  /// Bytes reserved by the arena
+  size_t capacity() const;
+
+  struct Header {
+    const Meta *meta;
+    size_t entity;
+    /// offset of the payload from the header
+    uint32_t payload;
+    /// offset of the next record from the header
+    uint32_t next;
+  };
+
+  protected:
+  struct Page {
+    std::unique_ptr<std::byte[]> data;
+    size_t size;
+    size_t used;
+  };
+
+  struct Position {
+    size_t page = 0;
+    size_t offset = 0;
+  };
+
+  template <typename T>
+  static void apply_typed(World &world, Header *const *records, size_t count);
+
+  template <typename F>
+  static void apply_custom(World &world, size_t, void *payload) {
+    (*static_cast<F *>(payload))(world);
+  }
+
+  template <typename T>
+  static void destroy(void *payload) {
+    static_cast<T *>(payload)->~T();
+  }
+
+  static void destroy_nothing(void *) {}
+
+  static void apply_nothing(World &, size_t, void *) {}
+
+  /// Placeholder of a record whose payload failed to be constructed
+  static const Meta *noop_meta() {
+    static const Meta meta {Op::Custom, std::type_index(typeid(void)), &apply_nothing, nullptr,
+                            &destroy_nothing};
+    return &meta;
+  }
+
+  static const Meta *despawn_meta() {
+    static const Meta meta {Op::Despawn, std::type_index(typeid(void)), nullptr, nullptr,
+                            &destroy_nothing};
+    return &meta;
+  }
+
+  template <typename T>
+  static const Meta *insert_meta() {
+    static const Meta meta {Op::Insert, std::type_index(typeid(T)), nullptr, &apply_typed<T>,
+                            &destroy<T>};
+    return &meta;
+  }
+
+  template <typename T>
+  static const Meta *remove_meta() {
+    static const Meta meta {Op::Remove, std::type_index(typeid(T)), nullptr, &apply_typed<T>,
+                            &destroy_nothing};
+    return &meta;
+  }
+
+  template <typename F>
+  static const Meta *custom_meta() {
+    static const Meta meta {Op::Custom, std::type_index(typeid(F)), &apply_custom<F>, nullptr,
+                            &destroy<F>};
+    return &meta;
+  }
+
+  template <typename T, typename... Args>
+  void push(const Meta *meta, size_t entity, Args &&...args) {
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "over-aligned types cannot be stored in a command buffer");
+    Header *header = allocate(sizeof(T), alignof(T));
+
+    new (payload_of(header)) T(std::forward<Args>(args)...);
+    header->meta = meta;
+    header->entity = entity;
+    _count += 1;
+  }
+
+  void push_empty(const Meta *meta, size_t entity) {
+    Header *header = allocate(0, 1);
+
+    header->meta = meta;
+    header->entity = entity;
+    _count += 1;
+  }
+
+  /// Reserve a record with room for a payload, it does nothing until its meta is set
+  Header *allocate(size_t size, size_t align);
+
+  Header *header_at(const Position &pos) {
+    return reinterpret_cast<Header *>(_pages[pos.page].data.get() + pos.offset);
+  }
+
+  static void *payload_of(Header *header) {
+    return reinterpret_cast<std::byte *>(header) + header->payload;
+  }
+
+  /// Position of the first record, false if there is none
+  bool first_record(Position &pos) const;
+
+  /// Move pos to the next record, false if there is none
+  bool next_record(Position &pos) const;
+
+  /// Destroy the records from pos to the end and reset the arena
+  void discard_from(Position pos);
+
+  /// Mark every page as empty, without destroying records
+  void reset();
+
+  /// Apply the records gathered in _batch, all inserts and removes or all despawns
+  void apply_batch(World &world);
+
+  /// Destroy the payloads of the records gathered in _batch
+  void destroy_batch();
+
+  size_t _page_size;
+  std::vector<Page> _pages;
+  size_t _current = 0;
+  size_t _count = 0;
+  /// records being applied together, kept to reuse its memory
+  std::vector<Header *> _batch;
+  std::vector<size_t> _despawned;
+};
@@ -0,0 +1,108 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Run conditions
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+#include "Access.hpp"
+#include "Event.hpp"
+#include "Scheduler.hpp"
+#include "World.hpp"
+
+namespace cevy::ecs {
+/**
+ * @brief Common run conditions, to be given to SystemConfig::run_if
+ *
+ * '''
+ * app.add_systems<core_stage::Update>(on_hit).run_if(condition::on_event<Hit>());
+ * app.add_systems<core_stage::Update>(replan).run_if(condition::every_n_ticks(10));
+ * '''
+ */
+namespace condition {
+/// true if the world holds the resource R
+template <typename R>
+RunCondition resource_exists() {
+  return {[](World &world) { return world.contains_resource<R>(); }, Access()};
+}
+
+/**
+ * @brief true if the resource R exists and is equal to value
+ *
+ * Serves as "state == X" when R is used as a state resource
+ */
+template <typename R>
+RunCondition resource_equals(const R &value) {
+  auto func = [value](World &world) {
+    auto res = world.get_resource<R>();
+    return res.has_value() && res.value().get() == value;
+  };
+  return {func, Access().read<R>()};
+}
+
+/**
+ * @brief true if the resource R changed since the last time this condition was evaluated
+ *
+ * There is no change tracking in the world, a copy of the resource is kept to compare against:
+ * R must be copyable and equality comparable, it should be kept small.
+ * The first evaluation with the resource present always returns true.
+ */
+template <typename R>
+RunCondition resource_changed() {
+  auto last = std::make_shared<std::optional<R>>(std::nullopt);
+
+  auto func = [last](World &world) {
+    auto res = world.get_resource<R>();
+    if (!res.has_value()) {
+      bool changed = last->has_value();
+      last->reset();
+      return changed;
+    }
+    const R &current = res.value().get();
+    if (last->has_value() && last->value() == current) {
+      return false;
+    }
+    last->emplace(current);
+    return true;
+  };
+  return {func, Access().read<R>().write_state(last.get())};
+}
+
+/**
+ * @brief true if events of T were sent since the last evaluation of this condition
+ *
+ * The condition keeps its own cursor, like an EventReader of a system: an event kept for two
+ * frames by the double buffer of Event makes it true only once.
+ */
+template <typename T>
+RunCondition on_event() {
+  auto cursor = std::make_shared<size_t>(0);
+
+  auto func = [cursor](World &world) {
+    if (!world.contains_resource<Event<T>>()) {
+      return false;
+    }
+    return !world.read_events<T>(*cursor).empty();
+  };
+  return {func, Access().read<Event<T>>().write_state(cursor.get())};
+}
+
+/// true once every n evaluations, starting with the first one
+inline RunCondition every_n_ticks(size_t n) {
+  auto counter = std::make_shared<size_t>(0);
+
+  auto func = [counter, n](World &) {
+    bool ready = *counter == 0;
+    *counter = (*counter + 1) % (n ? n : 1);
+    return ready;
+  };
+  return {func, Access().write_state(counter.get())};
+}
+} // namespace condition
+} // namespace cevy::ecs
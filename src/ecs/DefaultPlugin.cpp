@@ -8,6 +8,7 @@
 #include "DefaultPlugin.hpp"
 #include "App.hpp"
 #include "Time.hpp"
+#include "TimerWheel.hpp"
 
 void init_default_schedules(cevy::ecs::App &app) {
   using namespace cevy::ecs::core_stage;
@@ -28,4 +29,7 @@ void cevy::ecs::DefaultPlugin::build(cevy::ecs::App &app) {
   app.add_event<AppExit>();
   app.add_systems<cevy::ecs::core_stage::PostStartup>(init_timer);
   app.add_systems<cevy::ecs::core_stage::First>(update_timer);
+  app.add_event<TimerFinished>();
+  app.init_resource<TimerWheel>();
+  app.add_systems<cevy::ecs::core_stage::First>(TimerWheel::system);
 }
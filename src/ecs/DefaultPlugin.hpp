@@ -18,7 +18,7 @@ namespace cevy::ecs {
  *
  * Here are what is setup by this plugin
  * - Default Stages instanciated
- * - Timer Management
+ * - Timer Management, with the TimerWheel
  * - AppExit Event added
  * @warning Without it's instanciation or any replacement unexpected behavior might happend, treat
  * with care
@@ -7,24 +7,101 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
 #include <iterator>
+#include <memory>
 #include <tuple>
+#include <utility>
 #include <vector>
 
+#include "EventChannel.hpp"
+
 namespace cevy::ecs {
 class World;
 
 template <typename T>
 class EventWriter;
 
+/**
+ * @brief Double-buffered storage of the events of type T
+ *
+ * Events are appended to the current buffer. Each frame, update() turns the current buffer
+ * into the previous one and drops the events of the frame before, so an event lives
+ * for two updates whatever system sends or reads it.
+ * Every event gets an increasing id, which readers use as a cursor.
+ * Events pushed from other threads through an EventSender are added on update.
+ */
 template <typename T>
 class Event {
   public:
-  using EventWriterId = size_t;
-  using data_iterator_type = typename std::vector<std::tuple<T, EventWriterId>>::iterator;
+  using EventId = size_t;
+
+  void send(const T &event) { _current.events.push_back(event); }
+
+  void send(T &&event) { _current.events.push_back(std::move(event)); }
+
+  /// Swap the buffers, dropping the events sent before the last update,
+  /// then add the events pushed by the senders
+  void update() {
+    std::swap(_previous, _current);
+    _current.events.clear();
+    _current.start = _previous.start + _previous.events.size();
+    if (_channel) {
+      _channel->drain([this](T &&event) { send(std::move(event)); });
+    }
+  }
+
+  /**
+   * @brief Handle to send events from any thread
+   *
+   * The channel is created by the first call, with the given capacity,
+   * which must therefore not race with update().
+   */
+  EventSender<T> sender(size_t capacity = EventChannel<T>::default_capacity) {
+    if (!_channel) {
+      _channel = std::make_shared<EventChannel<T>>(capacity);
+    }
+    return EventSender<T>(_channel);
+  }
+
+  /// Drop every event
+  void clear() {
+    _current.start = next_id();
+    _current.events.clear();
+    _previous.start = _current.start;
+    _previous.events.clear();
+  }
+
+  /// Number of stored events, from both buffers
+  size_t size() const { return _previous.events.size() + _current.events.size(); }
+
+  bool empty() const { return size() == 0; }
+
+  /// Id of the oldest stored event
+  EventId first_id() const { return _previous.events.empty() ? _current.start : _previous.start; }
+
+  /// Id the next sent event will get
+  EventId next_id() const { return _current.start + _current.events.size(); }
+
+  /// Event with the given id, which must be in [first_id, next_id)
+  const T &at(EventId id) const {
+    if (id >= _current.start) {
+      return _current.events[id - _current.start];
+    }
+    return _previous.events[id - _previous.start];
+  }
+
+  protected:
+  struct Buffer {
+    std::vector<T> events {};
+    EventId start = 0;
+  };
 
-  std::vector<std::tuple<T, EventWriterId>> event_queue {};
+  Buffer _previous;
+  Buffer _current;
+  std::shared_ptr<EventChannel<T>> _channel;
 };
 
 template <typename T>
@@ -32,78 +109,100 @@ class EventWriter {
   private:
   friend class World;
   Event<T> &_event_access;
-  size_t _idx;
 
-  EventWriter(Event<T> &event_access, size_t idx) : _event_access(event_access), _idx(idx) {}
+  EventWriter(Event<T> &event_access) : _event_access(event_access) {}
 
   public:
   using value_type = T;
 
-  void clear() {
-    for (int i = _event_access.event_queue.size() - 1; i >= 0; i--)
-      if (std::get<1>(_event_access.event_queue.at(i)) == _idx)
-        _event_access.event_queue.erase(_event_access.event_queue.begin() + i);
-  }
+  /// Send an event, readers get it until the second update of the event queue
+  void send(const T &event) { _event_access.send(event); }
 
-  void send(const T &event) { _event_access.event_queue.push_back(std::make_tuple(event, _idx)); }
+  void send(T &&event) { _event_access.send(std::move(event)); }
 };
 
+/**
+ * @brief Events sent since the last run of the reading system
+ *
+ * The cursor of a system is kept by the Scheduler, each event is read exactly once
+ * by each reading system, as long as it runs at least every other frame.
+ */
 template <typename T>
 class EventReader {
   private:
   friend class World;
 
-  EventReader(const Event<T> &event_access) : raw_data(event_access) {}
+  EventReader(const Event<T> &event_access, size_t first)
+      : raw_data(event_access), _first(std::max(first, event_access.first_id())),
+        _last(event_access.next_id()) {}
 
   public:
   using value_type = T;
 
-  const Event<T> &raw_data; // TODO: replace by a query like iterator
+  const Event<T> &raw_data;
 
   class iterator {
     public:
     using iterator_category = std::bidirectional_iterator_tag;
     using value_type = T;
     using difference_type = std::ptrdiff_t;
-    using pointer = T *;
-    using reference = T &;
+    using pointer = const T *;
+    using reference = const T &;
 
-    using parent_iterator_type = typename std::vector<std::tuple<T, size_t>>::const_iterator;
+    iterator(const Event<T> &events, size_t id) : _events(&events), _id(id) {}
 
-    parent_iterator_type inner_iter;
+    iterator &operator++() {
+      _id++;
+      return *this;
+    };
 
-    iterator(parent_iterator_type &&inner_iter) : inner_iter(inner_iter) {}
+    iterator operator++(int) {
+      auto old = *this;
+      _id++;
+      return old;
+    };
 
-    iterator operator++() {
-      inner_iter++;
+    iterator &operator--() {
+      _id--;
       return *this;
     };
 
-    iterator &operator++(int) {
+    iterator operator--(int) {
       auto old = *this;
-      inner_iter++;
+      _id--;
       return old;
     };
 
-    value_type operator*() { return std::get<0>(*inner_iter); };
-    value_type operator->() { return std::get<0>(*inner_iter); };
-
-    operator reference() const { return std::get<0>(*inner_iter); };
+    reference operator*() const { return _events->at(_id); };
+    pointer operator->() const { return &_events->at(_id); };
 
     friend bool operator==(iterator const &lhs, iterator const &rhs) {
-      return lhs.inner_iter == rhs.inner_iter;
+      return lhs._id == rhs._id;
     };
     friend bool operator!=(iterator const &lhs, iterator const &rhs) {
-      return lhs.inner_iter != rhs.inner_iter;
+      return lhs._id != rhs._id;
     };
+
+    protected:
+    const Event<T> *_events;
+    size_t _id;
   };
 
   public:
-  const iterator cbegin() const { return iterator(raw_data.event_queue.cbegin()); };
-  const iterator cend() const { return iterator(raw_data.event_queue.cend()); };
-  const iterator begin() const { return iterator(raw_data.event_queue.cbegin()); };
-  const iterator end() const { return iterator(raw_data.event_queue.cend()); };
-  const iterator read() const { return iterator(raw_data.event_queue.begin()); };
+  iterator cbegin() const { return iterator(raw_data, _first); };
+  iterator cend() const { return iterator(raw_data, _last); };
+  iterator begin() const { return cbegin(); };
+  iterator end() const { return cend(); };
+  iterator read() const { return cbegin(); };
+
+  /// Number of events to read
+  size_t size() const { return _last - _first; }
+
+  bool empty() const { return _first == _last; }
+
+  protected:
+  size_t _first;
+  size_t _last;
 };
 } // namespace cevy::ecs
 
@@ -0,0 +1,159 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Event channel
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace cevy::ecs {
+/**
+ * @brief Bounded lock-free queue, with many producers and a single consumer
+ *
+ * Used to hand values from threads outside of the ECS, e.g. network, asset loading or
+ * OS callbacks, to the thread updating the world.
+ * Each cell carries a sequence number telling producers and the consumer whose turn it is,
+ * a producer only contends with other producers on the tail index.
+ */
+template <typename T>
+class EventChannel {
+  public:
+  static constexpr size_t default_capacity = 1024;
+
+  /// capacity is rounded up to a power of two
+  EventChannel(size_t capacity = default_capacity) {
+    size_t size = 2;
+
+    while (size < capacity) {
+      size *= 2;
+    }
+    _mask = size - 1;
+    _cells = std::make_unique<Cell[]>(size);
+    for (size_t i = 0; i < size; ++i) {
+      _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  EventChannel(const EventChannel &) = delete;
+  EventChannel &operator=(const EventChannel &) = delete;
+
+  ~EventChannel() {
+    while (consume([](T &&) {})) {
+    }
+  }
+
+  /**
+   * @brief Add a value, from any thread
+   *
+   * @return false if the channel is full, the value is dropped
+   */
+  template <typename U>
+  bool push(U &&value) {
+    size_t pos = _tail.load(std::memory_order_relaxed);
+    Cell *cell;
+
+    while (true) {
+      cell = &_cells[pos & _mask];
+      size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+
+      if (diff == 0) {
+        if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        pos = _tail.load(std::memory_order_relaxed);
+      }
+    }
+    new (cell->storage) T(std::forward<U>(value));
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Take the oldest value, from the consumer thread only
+   *
+   * @return false if the channel is empty
+   */
+  bool pop(T &value) {
+    return consume([&value](T &&stored) { value = std::move(stored); });
+  }
+
+  /// Call func on each value available, from the consumer thread only
+  template <typename F>
+  size_t drain(F &&func) {
+    size_t count = 0;
+
+    while (consume(func)) {
+      count += 1;
+    }
+    return count;
+  }
+
+  size_t capacity() const { return _mask + 1; }
+
+  /// Number of values refused because the channel was full
+  size_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+  protected:
+  template <typename F>
+  bool consume(F &&func) {
+    Cell &cell = _cells[_head & _mask];
+
+    if (cell.sequence.load(std::memory_order_acquire) != _head + 1) {
+      return false;
+    }
+    T *stored = std::launder(reinterpret_cast<T *>(cell.storage));
+    func(std::move(*stored));
+    stored->~T();
+    cell.sequence.store(_head + _mask + 1, std::memory_order_release);
+    _head += 1;
+    return true;
+  }
+
+  struct Cell {
+    std::atomic<size_t> sequence;
+    alignas(T) std::byte storage[sizeof(T)];
+  };
+
+  std::unique_ptr<Cell[]> _cells;
+  size_t _mask;
+  alignas(64) std::atomic<size_t> _tail {0};
+  alignas(64) size_t _head = 0;
+  std::atomic<size_t> _dropped {0};
+};
+
+/**
+ * @brief Thread-safe handle sending events of type T into the world
+ *
+ * Obtained from App::event_sender, it can be copied to any thread. The events are added to
+ * the event queue at the start of the next core_stage::First, in the order they were pushed.
+ * '''
+ * auto sender = app.event_sender<Packet>();
+ * std::thread io([sender]() mutable { sender.send(Packet {...}); });
+ * '''
+ */
+template <typename T>
+class EventSender {
+  public:
+  EventSender(std::shared_ptr<EventChannel<T>> channel) : _channel(std::move(channel)) {}
+
+  /// @return false if the channel is full, the event is dropped
+  bool send(const T &event) { return _channel->push(event); }
+
+  bool send(T &&event) { return _channel->push(std::move(event)); }
+
+  protected:
+  std::shared_ptr<EventChannel<T>> _channel;
+};
+} // namespace cevy::ecs
@@ -0,0 +1,157 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Frame timing statistics
+*/
+
+#include "FrameStats.hpp"
+#include "SystemStats.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+using cevy::ecs::FrameStats;
+
+FrameStats::FrameStats(size_t window, double hitch_threshold)
+    : _window(std::max<size_t>(window, 1)), _hitch_threshold(hitch_threshold) {
+  _frame.name = "frame";
+}
+
+void FrameStats::Track::push(double sample, size_t window) {
+  if (samples.size() < window) {
+    samples.push_back(sample);
+  } else {
+    sum -= samples[next];
+    samples[next] = sample;
+    next = (next + 1) % window;
+  }
+  sum += sample;
+  count += 1;
+}
+
+void FrameStats::record(Track &track, double sample) { track.push(sample, _window); }
+
+void FrameStats::begin_frame(time_point begin) {
+  if (_frame_begin) {
+    std::chrono::duration<double, std::milli> elapsed = begin - *_frame_begin;
+
+    record(_frame, elapsed.count());
+    if (elapsed.count() > _hitch_threshold) {
+      _total_hitches += 1;
+    }
+  }
+  _frame_begin = begin;
+}
+
+void FrameStats::record_stage(std::type_index stage, time_point begin, time_point end) {
+  std::chrono::duration<double, std::milli> elapsed = end - begin;
+  auto found = _stage_tracks.find(stage);
+
+  if (found == _stage_tracks.end()) {
+    found = _stage_tracks.emplace(stage, _stages.size()).first;
+    _stages.push_back(Track {SystemStats::type_name(stage), {}, 0, 0, 0});
+  }
+  record(_stages[found->second], elapsed.count());
+}
+
+static double percentile(const std::vector<double> &sorted, size_t percent) {
+  size_t idx = (sorted.size() * percent) / 100;
+
+  return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+FrameStats::Summary FrameStats::summarize(const Track &track) const {
+  Summary summary {track.name, track.samples.size(), 0, 0, 0, 0, 0, 0};
+
+  if (track.samples.empty()) {
+    return summary;
+  }
+  std::vector<double> sorted = track.samples;
+  std::sort(sorted.begin(), sorted.end());
+
+  summary.mean = track.sum / sorted.size();
+  summary.p50 = percentile(sorted, 50);
+  summary.p95 = percentile(sorted, 95);
+  summary.p99 = percentile(sorted, 99);
+  summary.max = sorted.back();
+  summary.hitches =
+      sorted.end() - std::upper_bound(sorted.begin(), sorted.end(), _hitch_threshold);
+  return summary;
+}
+
+FrameStats::Summary FrameStats::frame() const { return summarize(_frame); }
+
+std::vector<FrameStats::Summary> FrameStats::stages() const {
+  std::vector<Summary> ret;
+
+  ret.reserve(_stages.size());
+  for (const auto &track : _stages) {
+    ret.push_back(summarize(track));
+  }
+  return ret;
+}
+
+std::optional<FrameStats::Summary> FrameStats::stage(const std::string &name) const {
+  auto found = std::find_if(_stages.begin(), _stages.end(),
+                            [&name](const Track &track) { return track.name == name; });
+
+  if (found == _stages.end()) {
+    return std::nullopt;
+  }
+  return summarize(*found);
+}
+
+void FrameStats::export_csv(std::ostream &out) const {
+  auto write = [&out](const Summary &summary) {
+    out << summary.name << ',' << summary.samples << ',' << summary.mean << ',' << summary.p50
+        << ',' << summary.p95 << ',' << summary.p99 << ',' << summary.max << ','
+        << summary.hitches << '\n';
+  };
+
+  out << "name,samples,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,hitches\n";
+  write(frame());
+  for (const auto &summary : stages()) {
+    write(summary);
+  }
+}
+
+void FrameStats::export_json(std::ostream &out) const {
+  auto write = [&out](const Summary &summary) {
+    out << "{\"name\":\"" << summary.name << "\",\"samples\":" << summary.samples
+        << ",\"mean\":" << summary.mean << ",\"p50\":" << summary.p50
+        << ",\"p95\":" << summary.p95 << ",\"p99\":" << summary.p99 << ",\"max\":" << summary.max
+        << ",\"hitches\":" << summary.hitches << "}";
+  };
+
+  out << "{\"frames\":" << frame_count() << ",\"hitch_threshold\":" << _hitch_threshold
+      << ",\"total_hitches\":" << _total_hitches << ",\n\"frame\":";
+  write(frame());
+  out << ",\n\"stages\":[";
+  bool first = true;
+  for (const auto &summary : stages()) {
+    out << (first ? "\n" : ",\n");
+    write(summary);
+    first = false;
+  }
+  out << "\n]}\n";
+}
+
+template <typename F>
+static bool export_file(const std::string &path, F &&func) {
+  std::ofstream file(path);
+
+  if (!file.is_open()) {
+    return false;
+  }
+  func(file);
+  return file.good();
+}
+
+bool FrameStats::export_csv(const std::string &path) const {
+  return export_file(path, [this](std::ostream &out) { export_csv(out); });
+}
+
+bool FrameStats::export_json(const std::string &path) const {
+  return export_file(path, [this](std::ostream &out) { export_json(out); });
+}
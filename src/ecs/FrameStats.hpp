@@ -0,0 +1,112 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Frame timing statistics
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace cevy::ecs {
+/**
+ * @brief Resource keeping rolling statistics of the frame times and of each stage
+ *
+ * Only the duration of each frame, fed by update_timer, and of each stage, fed by the
+ * Scheduler, is recorded, which makes it cheap enough to keep in release builds,
+ * unlike SystemStats:
+ * '''
+ * app.init_resource<FrameStats>(600, 1000.0 / 30); // last 600 frames, hitches above 33ms
+ * ...
+ * app.resource<FrameStats>().export_json("frames.json");
+ * '''
+ * The frame time is measured from one update of Time to the next, with the same instant,
+ * so it matches Time::delta. Durations are in milliseconds.
+ */
+class FrameStats {
+  public:
+  using clock = std::chrono::high_resolution_clock;
+  using time_point = clock::time_point;
+
+  /// Rolling statistics of the frame or of a stage
+  struct Summary {
+    std::string name;
+    size_t samples;
+    double mean;
+    double p50;
+    double p95;
+    double p99;
+    double max;
+    /// samples of the window above the hitch threshold
+    size_t hitches;
+  };
+
+  FrameStats(size_t window = 600, double hitch_threshold = 1000.0 / 30);
+
+  /// Statistics of the frame times
+  Summary frame() const;
+
+  /// Statistics of each stage, in the order they first ran
+  std::vector<Summary> stages() const;
+
+  /// Statistics of the stage with the given name
+  std::optional<Summary> stage(const std::string &name) const;
+
+  /// Frames longer than the threshold since the creation of the resource
+  size_t total_hitches() const { return _total_hitches; }
+
+  /// Number of frames recorded since the creation of the resource
+  size_t frame_count() const { return _frame.count; }
+
+  double hitch_threshold() const { return _hitch_threshold; }
+
+  /// Frame, or stage, duration above which it counts as a hitch, in milliseconds
+  void set_hitch_threshold(double threshold) { _hitch_threshold = threshold; }
+
+  /// Write the summaries as CSV, one line for the frame then one per stage
+  void export_csv(std::ostream &out) const;
+
+  bool export_csv(const std::string &path) const;
+
+  /// Write the summaries as a json object
+  void export_json(std::ostream &out) const;
+
+  bool export_json(const std::string &path) const;
+
+  /// Start of a frame, called by update_timer
+  void begin_frame(time_point begin);
+
+  /* Scheduler interface */
+  void record_stage(std::type_index stage, time_point begin, time_point end);
+
+  protected:
+  struct Track {
+    std::string name;
+    std::vector<double> samples;
+    size_t next = 0;
+    size_t count = 0;
+    double sum = 0;
+
+    void push(double sample, size_t window);
+  };
+
+  Summary summarize(const Track &track) const;
+  void record(Track &track, double sample);
+
+  size_t _window;
+  double _hitch_threshold;
+  size_t _total_hitches = 0;
+  std::optional<time_point> _frame_begin;
+  Track _frame;
+  std::vector<Track> _stages;
+  std::unordered_map<std::type_index, size_t> _stage_tracks;
+};
+} // namespace cevy::ecs
@@ -119,14 +119,17 @@ class iterator {
   friend bool operator==(iterator const &lhs, iterator const &rhs) { return lhs._idx == rhs._idx; };
   friend bool operator!=(iterator const &lhs, iterator const &rhs) { return lhs._idx != rhs._idx; };
 
+  /// Slot of the current entity
+  size_t index() const { return _idx; }
+
   protected:
   void incr_all(size_t n = 1) {
     if (_idx == _max)
       return;
-    do {
-      _idx += n;
-      ((std::get<iterator_t<SparseVector<remove_optional<T>>>>(current) += n), ...);
-    } while (_idx < _max && !all_set()); // NOTE - check to choose <= or <
+    n = std::min(n, _max - _idx);
+    _idx += n;
+    ((std::get<iterator_t<SparseVector<remove_optional<T>>>>(current) += n), ...);
+    sync();
   }
 
   void sync() {
@@ -230,6 +233,14 @@ class Query {
 
   typename iterator_t::value_type single() { return *begin(); }
 
+  /// Iterator on the first entity whose slot is at least slot, to resume an iteration
+  iterator_t from(size_t slot) {
+    if (slot <= _begin.index()) {
+      return _begin;
+    }
+    return _begin + (slot - _begin.index());
+  }
+
   std::optional<typename iterator_t::value_type> get_single() {
     if (_size <= 0) {
       return std::nullopt;
@@ -9,19 +9,258 @@
 #include "Event.hpp"
 #include "World.hpp"
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+
 using cevy::ecs::Scheduler;
+using cevy::ecs::SystemStats;
+using cevy::ecs::World;
 
-void Scheduler::runStage(World &world) {
-  std::vector<std::reference_wrapper<system>> curr_sys;
+Scheduler::SystemId Scheduler::push_system(const system_function &func, std::type_index stage,
+                                           Access &&access, function_key key,
+                                           std::shared_ptr<SystemState> state) {
+  SystemId id = _systems.size();
+  std::string name = SystemStats::type_name(stage) + "#" + std::to_string(id);
+
+  _systems.push_back(system {id, name, func, stage, {}, std::move(access), key});
+  _systems.back().state = state ? std::move(state) : std::make_shared<SystemState>();
+  _graphs.clear();
+  return id;
+}
+
+bool Scheduler::matches(const system &sys, const SystemLabel &label) const {
+  switch (label.kind) {
+  case SystemLabel::Kind::Id:
+    return sys.id == label.id;
+  case SystemLabel::Kind::Function:
+    return sys.key != nullptr && sys.key == label.function;
+  case SystemLabel::Kind::Set:
+    return std::find(sys.sets.begin(), sys.sets.end(), label.set) != sys.sets.end();
+  }
+  return false;
+}
+
+const Scheduler::StageGraph &Scheduler::stage_graph(std::type_index stage) {
+  auto found = _graphs.find(stage);
+
+  if (found != _graphs.end()) {
+    return found->second;
+  }
 
-  std::copy_if(_systems.begin(), _systems.end(), std::back_inserter(curr_sys),
-               [this](const system &sys) { return std::get<1>(sys) == *_stage; });
+  std::vector<SystemId> nodes;
+  for (const auto &sys : _systems) {
+    if (sys.stage == stage) {
+      nodes.push_back(sys.id);
+    }
+  }
+  size_t count = nodes.size();
+  std::vector<std::vector<bool>> edges(count, std::vector<bool>(count, false));
+
+  /* explicit ordering */
+  for (size_t i = 0; i < count; ++i) {
+    const system &sys = _systems[nodes[i]];
+
+    for (size_t j = 0; j < count; ++j) {
+      if (i == j) {
+        continue;
+      }
+      const system &other = _systems[nodes[j]];
+      for (const auto &label : sys.after) {
+        if (matches(other, label)) {
+          edges[j][i] = true;
+        }
+      }
+      for (const auto &label : sys.before) {
+        if (matches(other, label)) {
+          edges[i][j] = true;
+        }
+      }
+    }
+  }
 
-  /* this part could be multi-threaded */
-  for (auto sys : curr_sys) {
-    std::get<0>(sys.get())(world);
+  /* topological sort, ties are broken by registration order */
+  std::vector<size_t> incoming(count, 0);
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t j = 0; j < count; ++j) {
+      incoming[j] += edges[i][j];
+    }
   }
+  std::set<size_t> ready;
+  std::vector<size_t> sorted;
+  for (size_t i = 0; i < count; ++i) {
+    if (incoming[i] == 0) {
+      ready.insert(i);
+    }
+  }
+  while (!ready.empty()) {
+    size_t node = *ready.begin();
 
+    ready.erase(ready.begin());
+    sorted.push_back(node);
+    for (size_t next = 0; next < count; ++next) {
+      if (edges[node][next] && --incoming[next] == 0) {
+        ready.insert(next);
+      }
+    }
+  }
+  if (sorted.size() != count) {
+    std::string cycle;
+    for (size_t i = 0; i < count; ++i) {
+      if (incoming[i] != 0) {
+        cycle += (cycle.empty() ? "" : ", ") + _systems[nodes[i]].name;
+      }
+    }
+    throw(std::runtime_error("Cevy/Ecs: Cycle in the system ordering of stage " +
+                             SystemStats::type_name(stage) + ": " + cycle));
+  }
+
+  /* systems accessing the same data keep the sorted order */
+  for (size_t a = 0; a < count; ++a) {
+    for (size_t b = a + 1; b < count; ++b) {
+      size_t first = sorted[a];
+      size_t second = sorted[b];
+
+      if (_systems[nodes[first]].access.conflicts(_systems[nodes[second]].access)) {
+        edges[first][second] = true;
+      }
+    }
+  }
+
+  StageGraph graph;
+  for (auto id : nodes) {
+    if (_systems[id].state->commands) {
+      graph.deferred.push_back(id);
+    }
+  }
+  std::vector<size_t> position(count);
+  for (size_t i = 0; i < count; ++i) {
+    position[sorted[i]] = i;
+    graph.order.push_back(nodes[sorted[i]]);
+  }
+  graph.successors.resize(count);
+  graph.dependencies.resize(count, 0);
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t j = 0; j < count; ++j) {
+      if (edges[i][j]) {
+        graph.successors[position[i]].push_back(position[j]);
+        graph.dependencies[position[j]] += 1;
+      }
+    }
+  }
+  return _graphs.emplace(stage, std::move(graph)).first->second;
+}
+
+void Scheduler::runSystem(World &world, system &sys) {
+  bool should_run = std::all_of(sys.conditions.begin(), sys.conditions.end(),
+                                [&world](condition_function &cond) { return cond(world); });
+
+  if (!should_run) {
+    return;
+  }
+  if (_stats) {
+    auto begin = SystemStats::clock::now();
+    sys.func(world);
+    _stats->record_system(sys.id, sys.name, begin, SystemStats::clock::now(),
+                          TaskPool::thread_index());
+  } else {
+    sys.func(world);
+  }
+}
+
+void Scheduler::runGraph(World &world, const StageGraph &graph) {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<size_t> dependencies = graph.dependencies;
+  std::deque<size_t> ready;
+  std::deque<size_t> ready_main;
+  size_t done = 0;
+  std::exception_ptr error = nullptr;
+
+  auto push_ready = [&](size_t node) {
+    const system &sys = _systems[graph.order[node]];
+
+    (sys.main_thread || sys.access.is_exclusive() ? ready_main : ready).push_back(node);
+  };
+  auto run = [&](size_t node) {
+    try {
+      runSystem(world, _systems[graph.order[node]]);
+    } catch (...) {
+      std::lock_guard lock(mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+    std::lock_guard lock(mutex);
+    done += 1;
+    for (auto next : graph.successors[node]) {
+      if (--dependencies[next] == 0) {
+        push_ready(next);
+      }
+    }
+    cv.notify_all();
+  };
+
+  std::unique_lock lock(mutex);
+  for (size_t node = 0; node < graph.order.size(); ++node) {
+    if (dependencies[node] == 0) {
+      push_ready(node);
+    }
+  }
+  while (done < graph.order.size()) {
+    if (!ready_main.empty()) {
+      size_t node = ready_main.front();
+
+      ready_main.pop_front();
+      lock.unlock();
+      run(node);
+      lock.lock();
+    } else if (!ready.empty()) {
+      while (!ready.empty()) {
+        _pool->spawn([&run, node = ready.front()]() { run(node); });
+        ready.pop_front();
+      }
+    } else {
+      lock.unlock();
+      bool helped = _pool->try_run_one();
+      lock.lock();
+      if (!helped && ready.empty() && ready_main.empty() && done < graph.order.size()) {
+        cv.wait(lock);
+      }
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void Scheduler::runStage(World &world) {
+  bool timed = _stats || _frame_stats;
+  auto stage_begin = timed ? SystemStats::clock::now() : SystemStats::time_point();
+  const StageGraph &graph = stage_graph(*_stage);
+
+  if (_pool && _pool->size() > 1 && graph.order.size() > 1) {
+    runGraph(world, graph);
+  } else {
+    for (auto id : graph.order) {
+      runSystem(world, _systems[id]);
+    }
+  }
+  flushCommands(world, graph.deferred);
+
+  if (timed) {
+    auto stage_end = SystemStats::clock::now();
+
+    if (_stats) {
+      _stats->record_stage(*_stage, stage_begin, stage_end);
+    }
+    if (_frame_stats) {
+      _frame_stats->record_stage(*_stage, stage_begin, stage_end);
+    }
+  }
   _stage++;
 }
 
@@ -39,18 +278,68 @@ void Scheduler::runStages(World &world) {
   }
 }
 
+void Scheduler::flushCommands(World &world, const std::vector<SystemId> &deferred) {
+  bool pending = !world._command_queue.empty();
+
+  for (auto id : deferred) {
+    pending = pending || !_systems[id].state->commands->empty();
+  }
+  world.flush_reserved_entities();
+  if (!pending) {
+    return;
+  }
+  auto begin = _stats ? SystemStats::clock::now() : SystemStats::time_point();
+
+  /* the buffers are applied in registration order, whichever thread filled them */
+  for (auto id : deferred) {
+    _systems[id].state->commands->apply(world);
+  }
+  world._command_queue.apply(world);
+  if (_stats) {
+    _stats->record_commands(begin, SystemStats::clock::now());
+  }
+}
+
+template <typename R>
+static R *find_resource(World &world) {
+  auto res = world.get_resource<R>();
+
+  return res ? &res.value().get() : nullptr;
+}
+
 void Scheduler::run(World &world) {
+  _stats = find_resource<SystemStats>(world);
+  _pool = find_resource<TaskPool>(world);
+  if (_stats) {
+    _stats->begin_frame(SystemStats::clock::now());
+  }
   runStartStages(world);
+  if (_stats) {
+    _stats->end_frame(SystemStats::clock::now());
+  }
   while (!_stop) {
+    _stats = find_resource<SystemStats>(world);
+    _frame_stats = find_resource<FrameStats>(world);
+    _pool = find_resource<TaskPool>(world);
+    if (_stats) {
+      _stats->begin_frame(SystemStats::clock::now());
+    }
     runStages(world);
-    while (!world._command_queue.empty()) {
-      std::function<void(World &)> func = world._command_queue.front();
-      world._command_queue.pop();
-      func(world);
+    flushCommands(world, {});
+    world.drop_deferred();
+    if (_stats) {
+      _stats->end_frame(SystemStats::clock::now());
     }
     auto close = world.get_resource<Event<AppExit>>();
-    if (close && close.value().get().event_queue.size() > 0) {
+    if (close && !close.value().get().empty()) {
       _stop = true;
     }
   }
+  _stats = find_resource<SystemStats>(world);
+  if (_stats && _stats->exit_path()) {
+    _stats->export_chrome_trace(*_stats->exit_path());
+  }
+  _stats = nullptr;
+  _frame_stats = nullptr;
+  _pool = nullptr;
 }
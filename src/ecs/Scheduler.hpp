@@ -11,13 +11,23 @@
 #include <functional>
 #include <iostream>
 #include <list>
+#include <memory>
 #include <optional>
+#include <stdexcept>
+#include <string>
 #include <tuple>
 #include <type_traits>
 #include <typeindex>
+#include <unordered_map>
+#include <vector>
 
+#include "Access.hpp"
+#include "Budget.hpp"
 #include "Event.hpp"
 #include "Stage.hpp"
+#include "FrameStats.hpp"
+#include "SystemStats.hpp"
+#include "TaskPool.hpp"
 #include "World.hpp"
 #include "ecs.hpp"
 
@@ -26,7 +36,18 @@ namespace cevy::ecs {
 typedef struct AppExit {
 } AppExit;
 
+/**
+ * @brief A run condition and the world data it reads
+ *
+ * Returned by the helpers of the condition namespace
+ */
+struct RunCondition {
+  std::function<bool(World &)> func;
+  Access access;
+};
+
 class Scheduler {
+  public:
   using SystemId = size_t;
 
   private:
@@ -91,77 +112,484 @@ class Scheduler {
   }
 
   using system_function = std::function<void(World &)>;
-  using system = std::tuple<system_function, std::type_index>;
+  using condition_function = std::function<bool(World &)>;
+  /// Identifies a system by the function it was made from
+  using function_key = void (*)();
+
+  /**
+   * @brief What a system is ordered against: a system, every system made from a function,
+   * or a named set of systems
+   */
+  struct SystemLabel {
+    enum class Kind { Id, Function, Set };
+
+    Kind kind;
+    SystemId id = 0;
+    function_key function = nullptr;
+    std::string set = "";
+  };
+
+  /// Data owned by a system and handed to its parameters, kept between runs
+  struct SystemState {
+    /// cursor and limits of a system taking a Budget, null otherwise
+    std::shared_ptr<BudgetState> budget = nullptr;
+    /// deferred operations of a system taking Commands, null otherwise
+    std::shared_ptr<CommandBuffer> commands = nullptr;
+    /// id of the next event to read, for each EventReader of the system
+    std::unordered_map<std::type_index, size_t> event_cursors = {};
+  };
+
+  /**
+   * @brief A registered system and the stage it runs in
+   *
+   * Run conditions are evaluated in order before the system parameters are bound,
+   * the system is skipped as soon as one of them returns false.
+   * The name is used to report the system in SystemStats.
+   */
+  struct system {
+    SystemId id;
+    std::string name;
+    system_function func;
+    std::type_index stage;
+    std::vector<condition_function> conditions;
+    Access access;
+    function_key key = nullptr;
+    std::vector<std::string> sets = {};
+    std::vector<SystemLabel> before = {};
+    std::vector<SystemLabel> after = {};
+    bool main_thread = false;
+    std::shared_ptr<SystemState> state = nullptr;
+  };
   std::vector<system> _systems;
   Scheduler() : _stage(_at_start_schedule.begin()) {};
   ~Scheduler() = default;
 
   template <class F, class S, class... Args>
-  void add_class_system(const F &func) {
+  SystemId add_class_system(const F &func) {
     static_assert(
-        all(Or<is_query<Args>, is_world<Args>, is_resource<Args>, is_commands<Args>>()...),
-        "type must be reference to query, world, commands or resource");
+        all(Or<is_query<Args>, is_world<Args>, is_resource<Args>, is_commands<Args>,
+               is_budget<Args>>()...),
+        "type must be reference to query, world, commands, budget or resource");
 
     if (!schedule_defined<S>()) {
       std::cerr << "WARNING/Cevy: Stage not yet added to ecs pipeline" << std::endl;
     }
 
-    system_function sys = [id = this->last_id, &func](World &reg) mutable {
-      func(reg.get_super<Args>(id)...);
+    auto state = make_state<Args...>();
+    system_function sys = [id = this->last_id, &func, state](World &reg) mutable {
+      func(bind_param<Args>(reg, id, *state)...);
     };
-    _systems.push_back(std::make_tuple(sys, std::type_index(typeid(S))));
+    last_id += 1;
+    return push_system(sys, std::type_index(typeid(S)), Access::of<Args...>(), nullptr, state);
   }
 
   template <class R, class... Args>
-  void add_system(R(func)(Args...)) {
-    add_system<core_stage::Update>(func);
+  SystemId add_system(R(func)(Args...)) {
+    return add_system<core_stage::Update>(func);
   }
 
   template <class S, class R, class... Args>
-  void add_system(const std::function<R(Args...)> &func) {
+  SystemId add_system(const std::function<R(Args...)> &func) {
     static_assert(
-        all(Or<is_query<Args>, is_world<Args>, is_resource<Args>, is_commands<Args>>()...),
-        "type must be reference to query, world, commands or resource");
+        all(Or<is_query<Args>, is_world<Args>, is_resource<Args>, is_commands<Args>,
+               is_budget<Args>>()...),
+        "type must be reference to query, world, commands, budget or resource");
     if (!schedule_defined<S>()) {
       std::cerr << "WARNING/Cevy: Stage not yet added to ecs pipeline" << std::endl;
     }
-    system_function sys = [id = this->last_id, &func](World &reg) {
-      func(reg.get_super<Args>(id)...);
+    auto state = make_state<Args...>();
+    system_function sys = [id = this->last_id, &func, state](World &reg) {
+      func(bind_param<Args>(reg, id, *state)...);
     };
     this->last_id += 1;
-    _systems.push_back(std::make_tuple(sys, std::type_index(typeid(S))));
+    return push_system(sys, std::type_index(typeid(S)), Access::of<Args...>(), nullptr, state);
   }
 
   template <class S, class R, class... Args>
-  void add_system(R(func)(Args...)) {
+  SystemId add_system(R(func)(Args...)) {
     static_assert(
         all(Or<is_query<Args>, is_world<Args>, is_resource<Args>, is_commands<Args>,
-               is_event_reader<Args>, is_event_writer<Args>>()...),
-        "type must be reference to query, world, commands, event reader, event writer or resource");
+               is_event_reader<Args>, is_event_writer<Args>, is_budget<Args>>()...),
+        "type must be reference to query, world, commands, event reader, event writer, budget or "
+        "resource");
 #ifdef DEBUG
     if (!schedule_defined<S>()) {
       std::cerr << "WARNING/Cevy: Stage not yet added to ecs pipeline" << std::endl;
     }
 #endif
 
-    system_function sys = [id = this->last_id, func](World &reg) {
-      func(reg.get_super<Args>(id)...);
+    auto state = make_state<Args...>();
+    system_function sys = [id = this->last_id, func, state](World &reg) {
+      func(bind_param<Args>(reg, id, *state)...);
     };
     last_id += 1;
-    _systems.push_back(std::make_tuple(sys, std::type_index(typeid(S))));
+    return push_system(sys, std::type_index(typeid(S)), Access::of<Args...>(),
+                       reinterpret_cast<function_key>(func), state);
+  }
+
+  /**
+   * @brief Add a run condition to an already registered system
+   *
+   * A condition is a cheap predicate system: it receives its own parameters and returns
+   * whether the system should run this cycle.
+   * Its access is added to the one of the system, a bare function of the world is assumed
+   * to read everything.
+   * The EventReaders of a condition have their own cursors, kept between evaluations.
+   */
+  void add_condition(SystemId id, RunCondition &&condition) {
+    auto &sys = _systems.at(id);
+
+    sys.conditions.push_back(std::move(condition.func));
+    sys.access.merge(condition.access);
+    _graphs.clear();
+  }
+
+  void add_condition(SystemId id, condition_function &&condition) {
+    add_condition(id, RunCondition {std::move(condition), Access::read_all()});
+  }
+
+  template <class R, class... Args>
+  void add_condition(SystemId id, R(func)(Args...)) {
+    static_assert(std::is_convertible_v<R, bool>, "run condition must return a boolean");
+    static_assert(
+        all(Or<is_query<Args>, is_world<Args>, is_resource<Args>, is_event_reader<Args>>()...),
+        "run condition parameters must be query, world, event reader or resource");
+    auto state = std::make_shared<SystemState>();
+
+    add_condition(id, RunCondition {[id, func, state](World &reg) -> bool {
+                                      return func(bind_param<Args>(reg, id, *state)...);
+                                    },
+                                    Access::of<Args...>()});
+  }
+
+  template <class R, class... Args>
+  void add_condition(SystemId id, const std::function<R(Args...)> &func) {
+    static_assert(std::is_convertible_v<R, bool>, "run condition must return a boolean");
+    static_assert(
+        all(Or<is_query<Args>, is_world<Args>, is_resource<Args>, is_event_reader<Args>>()...),
+        "run condition parameters must be query, world, event reader or resource");
+    auto state = std::make_shared<SystemState>();
+
+    add_condition(id, RunCondition {[id, func, state](World &reg) -> bool {
+                                      return func(bind_param<Args>(reg, id, *state)...);
+                                    },
+                                    Access::of<Args...>()});
+  }
+
+  /// Set the name under which the system is reported in SystemStats
+  void set_name(SystemId id, const std::string &name) { _systems.at(id).name = name; }
+
+  /// Run the system after the systems matching label, in the same stage
+  void add_after(SystemId id, SystemLabel &&label) {
+    _systems.at(id).after.push_back(std::move(label));
+    _graphs.clear();
+  }
+
+  /// Run the system before the systems matching label, in the same stage
+  void add_before(SystemId id, SystemLabel &&label) {
+    _systems.at(id).before.push_back(std::move(label));
+    _graphs.clear();
   }
 
+  /// Add the system to a named set, sets can be used as labels by other systems
+  void add_to_set(SystemId id, const std::string &set) {
+    _systems.at(id).sets.push_back(set);
+    _graphs.clear();
+  }
+
+  /// Always run the system on the thread that called run, e.g. for graphics or windowing calls
+  void pin_main_thread(SystemId id) { _systems.at(id).main_thread = true; }
+
+  /**
+   * @brief Budget of a system taking a Budget parameter, null for other systems
+   *
+   * The state can be kept to follow the progress of the system, e.g. its completed passes
+   */
+  std::shared_ptr<BudgetState> budget(SystemId id) const { return _systems.at(id).state->budget; }
+
   protected:
+  /**
+   * @brief Systems of a stage in a valid run order and the dependencies between them
+   *
+   * Indices are positions in order: a system can start once all of its dependencies
+   * have finished, successors lists which systems wait on it.
+   */
+  struct StageGraph {
+    std::vector<SystemId> order;
+    std::vector<std::vector<size_t>> successors;
+    std::vector<size_t> dependencies;
+    /// systems owning a command buffer, in registration order
+    std::vector<SystemId> deferred;
+  };
+
   mutable bool _stop = false;
   std::list<std::type_index>::iterator _stage;
+  /// timing sink of the current frame, null when SystemStats is not a resource of the world
+  SystemStats *_stats = nullptr;
+  /// frame time sink of the current frame, null when FrameStats is not a resource of the world
+  FrameStats *_frame_stats = nullptr;
+  /// workers of the current frame, null when TaskPool is not a resource of the world
+  TaskPool *_pool = nullptr;
+  /// cached graph of each stage, cleared whenever a system or its ordering changes
+  std::unordered_map<std::type_index, StageGraph> _graphs;
 
   void runStartStages(World &world);
   void runStages(World &world);
   void runStage(World &world);
+  void runSystem(World &world, system &sys);
+  void runGraph(World &world, const StageGraph &graph);
+  void flushCommands(World &world, const std::vector<SystemId> &deferred);
+
+  const StageGraph &stage_graph(std::type_index stage);
+  bool matches(const system &sys, const SystemLabel &label) const;
+
+  SystemId push_system(const system_function &func, std::type_index stage, Access &&access,
+                       function_key key = nullptr,
+                       std::shared_ptr<SystemState> state = nullptr);
+
+  template <typename... Args>
+  static std::shared_ptr<SystemState> make_state() {
+    auto state = std::make_shared<SystemState>();
+
+    if constexpr ((is_budget<Args>::value || ...)) {
+      state->budget = std::make_shared<BudgetState>();
+    }
+    if constexpr ((is_commands<Args>::value || ...)) {
+      state->commands = std::make_shared<CommandBuffer>();
+    }
+    return state;
+  }
+
+  /// Bind a system parameter, from the world or from the state of the system
+  template <typename Arg>
+  static decltype(auto) bind_param(World &world, SystemId id, SystemState &state) {
+    if constexpr (is_budget<Arg>::value) {
+      return Budget(*state.budget);
+    } else if constexpr (is_commands<Arg>::value) {
+      return Arg(world, *state.commands);
+    } else if constexpr (is_event_reader<Arg>::value) {
+      using T = typename Arg::value_type;
+      return world.read_events<T>(state.event_cursors[std::type_index(typeid(T))]);
+    } else {
+      return world.get_super<Arg>(id);
+    }
+  }
 
   private:
   /* Bevy-compliant */
   public:
   void run(World &world);
 };
+
+/**
+ * @brief Handle on freshly added systems, used to configure them
+ *
+ * Returned by App::add_systems, every setting applies to all the systems added in that call
+ *
+ * '''
+ * app.add_systems<core_stage::Update>(on_hit).run_if(condition::on_event<Hit>());
+ * app.add_systems<core_stage::Update>(apply_forces, integrate).chain().in_set("physics");
+ * app.add_systems<core_stage::Update>(follow_camera).after("physics");
+ * '''
+ */
+class SystemConfig {
+  public:
+  using SystemId = Scheduler::SystemId;
+
+  SystemConfig(Scheduler &scheduler, std::vector<SystemId> &&ids)
+      : _scheduler(scheduler), _ids(std::move(ids)) {};
+
+  /**
+   * @brief Only run the systems when the condition returns true
+   *
+   * Conditions are evaluated before any of the system parameters are bound,
+   * a skipped system costs no query nor resource lookup.
+   * Multiple conditions are combined: all of them must be true.
+   */
+  SystemConfig &run_if(Scheduler::condition_function &&condition) {
+    for (auto id : _ids) {
+      _scheduler.add_condition(id, Scheduler::condition_function(condition));
+    }
+    return *this;
+  }
+
+  SystemConfig &run_if(RunCondition &&condition) {
+    for (auto id : _ids) {
+      _scheduler.add_condition(id, RunCondition(condition));
+    }
+    return *this;
+  }
+
+  template <class R, class... Args>
+  SystemConfig &run_if(R(func)(Args...)) {
+    for (auto id : _ids) {
+      _scheduler.add_condition(id, func);
+    }
+    return *this;
+  }
+
+  template <class R, class... Args>
+  SystemConfig &run_if(const std::function<R(Args...)> &func) {
+    for (auto id : _ids) {
+      _scheduler.add_condition(id, func);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Name the systems in SystemStats and exported traces
+   *
+   * When configuring multiple systems, their position is appended to the name
+   */
+  SystemConfig &named(const std::string &name) {
+    for (size_t i = 0; i < _ids.size(); ++i) {
+      _scheduler.set_name(_ids[i], _ids.size() == 1 ? name : name + "#" + std::to_string(i));
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Run the systems after the given ones, within their stage
+   *
+   * Ordering only applies between systems of a same stage, stages are already run in sequence.
+   * Systems that are not ordered and do not access the same data may run in parallel
+   * when a TaskPool resource is present.
+   */
+  SystemConfig &after(const SystemConfig &other) {
+    for (auto id : _ids) {
+      for (auto other_id : other._ids) {
+        _scheduler.add_after(id, label(other_id));
+      }
+    }
+    return *this;
+  }
+
+  /// Run the systems after every system made from func
+  template <class R, class... Args>
+  SystemConfig &after(R(func)(Args...)) {
+    for (auto id : _ids) {
+      _scheduler.add_after(id, label(func));
+    }
+    return *this;
+  }
+
+  /// Run the systems after every system of the named set
+  SystemConfig &after(const std::string &set) {
+    for (auto id : _ids) {
+      _scheduler.add_after(id, label(set));
+    }
+    return *this;
+  }
+
+  /// Run the systems before the given ones, within their stage
+  SystemConfig &before(const SystemConfig &other) {
+    for (auto id : _ids) {
+      for (auto other_id : other._ids) {
+        _scheduler.add_before(id, label(other_id));
+      }
+    }
+    return *this;
+  }
+
+  /// Run the systems before every system made from func
+  template <class R, class... Args>
+  SystemConfig &before(R(func)(Args...)) {
+    for (auto id : _ids) {
+      _scheduler.add_before(id, label(func));
+    }
+    return *this;
+  }
+
+  /// Run the systems before every system of the named set
+  SystemConfig &before(const std::string &set) {
+    for (auto id : _ids) {
+      _scheduler.add_before(id, label(set));
+    }
+    return *this;
+  }
+
+  /// Add the systems to the named set
+  SystemConfig &in_set(const std::string &set) {
+    for (auto id : _ids) {
+      _scheduler.add_to_set(id, set);
+    }
+    return *this;
+  }
+
+  /// Run the systems one after the other, in the order they were given
+  SystemConfig &chain() {
+    for (size_t i = 1; i < _ids.size(); ++i) {
+      _scheduler.add_after(_ids[i], label(_ids[i - 1]));
+    }
+    return *this;
+  }
+
+  /// Always run the systems on the main thread
+  SystemConfig &main_thread() {
+    for (auto id : _ids) {
+      _scheduler.pin_main_thread(id);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Limit the work of systems taking a Budget parameter, per frame
+   *
+   * The systems stop once either limit is reached and resume from their cursor next frame.
+   */
+  template <typename Rep, typename Period>
+  SystemConfig &with_budget(std::chrono::duration<Rep, Period> time,
+                            std::optional<size_t> items = std::nullopt) {
+    for (auto id : _ids) {
+      auto budget = checked_budget(id);
+      budget->time = time;
+      budget->items = items;
+    }
+    return *this;
+  }
+
+  /// Limit the number of items processed per frame by systems taking a Budget parameter
+  SystemConfig &with_budget(size_t items) {
+    for (auto id : _ids) {
+      auto budget = checked_budget(id);
+      budget->time = std::nullopt;
+      budget->items = items;
+    }
+    return *this;
+  }
+
+  /// Budget state of the first configured system, see Scheduler::budget
+  std::shared_ptr<BudgetState> budget() const {
+    return _ids.empty() ? nullptr : _scheduler.budget(_ids.front());
+  }
+
+  const std::vector<SystemId> &ids() const { return _ids; }
+
+  protected:
+  using SystemLabel = Scheduler::SystemLabel;
+
+  static SystemLabel label(SystemId id) { return SystemLabel {SystemLabel::Kind::Id, id}; }
+
+  static SystemLabel label(const std::string &set) {
+    return SystemLabel {SystemLabel::Kind::Set, 0, nullptr, set};
+  }
+
+  template <class R, class... Args>
+  static SystemLabel label(R(func)(Args...)) {
+    return SystemLabel {SystemLabel::Kind::Function, 0,
+                        reinterpret_cast<Scheduler::function_key>(func)};
+  }
+
+  std::shared_ptr<BudgetState> checked_budget(SystemId id) {
+    auto budget = _scheduler.budget(id);
+
+    if (!budget) {
+      throw(std::runtime_error("Cevy/Ecs: Budget given to a system without Budget parameter"));
+    }
+    return budget;
+  }
+
+  Scheduler &_scheduler;
+  std::vector<SystemId> _ids;
+};
 } // namespace cevy::ecs
@@ -73,7 +73,7 @@ class SparseVector {
   reference_type insert_at(size_type pos, Type &&val) {
     if (pos >= _data.size())
       _data.resize(pos + 1, std::nullopt);
-    _data[pos] = std::optional(val);
+    _data[pos] = std::optional<Type>(std::move(val));
     return _data[pos];
   }
 
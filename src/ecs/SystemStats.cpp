@@ -0,0 +1,202 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** System timing statistics
+*/
+
+#include "SystemStats.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+#ifdef __GNUG__
+#include <cstdlib>
+#include <cxxabi.h>
+#include <memory>
+#endif
+
+using cevy::ecs::SystemStats;
+
+static const char *category_name(SystemStats::Category category) {
+  switch (category) {
+  case SystemStats::Category::Frame:
+    return "frame";
+  case SystemStats::Category::Stage:
+    return "stage";
+  case SystemStats::Category::System:
+    return "system";
+  case SystemStats::Category::Commands:
+    return "commands";
+  }
+  return "unknown";
+}
+
+static void write_escaped(std::ostream &out, const std::string &str) {
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      out << '\\';
+    }
+    out << c;
+  }
+}
+
+std::string SystemStats::type_name(std::type_index type) {
+  std::string name = type.name();
+
+#ifdef __GNUG__
+  int status = 0;
+  std::unique_ptr<char, void (*)(void *)> demangled(
+      abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status), std::free);
+  if (status == 0 && demangled) {
+    name = demangled.get();
+  }
+#endif
+  auto last = name.rfind("::");
+  if (last != std::string::npos) {
+    name = name.substr(last + 2);
+  }
+  return name;
+}
+
+SystemStats::SystemStats(size_t frames, size_t window)
+    : _window(std::max<size_t>(window, 1)), _epoch(clock::now()), _frame_begin(_epoch) {
+  _frames.resize(std::max<size_t>(frames, 1));
+  _frame_track = add_track("frame", Category::Frame);
+  _commands_track = add_track("commands", Category::Commands);
+}
+
+void SystemStats::RollingWindow::push(double sample, size_t window) {
+  if (samples.size() < window) {
+    samples.push_back(sample);
+  } else {
+    sum -= samples[next];
+    samples[next] = sample;
+    next = (next + 1) % window;
+  }
+  sum += sample;
+}
+
+size_t SystemStats::add_track(const std::string &name, Category category) {
+  _tracks.push_back(Track {name, category, {}});
+  return _tracks.size() - 1;
+}
+
+void SystemStats::record(size_t track, time_point begin, time_point end, size_t thread) {
+  std::chrono::duration<double, std::milli> elapsed = end - begin;
+
+  _tracks[track].window.push(elapsed.count(), _window);
+  _frames[_frame_count % _frames.size()].spans.push_back(Span {track, begin, end, thread});
+}
+
+void SystemStats::begin_frame(time_point begin) {
+  _frame_begin = begin;
+  _frames[_frame_count % _frames.size()].spans.clear();
+}
+
+void SystemStats::end_frame(time_point end) {
+  record(_frame_track, _frame_begin, end);
+  _frame_count += 1;
+}
+
+void SystemStats::record_system(size_t system_id, const std::string &name, time_point begin,
+                                time_point end, size_t thread) {
+  std::lock_guard lock(*_mutex);
+
+  if (system_id >= _system_tracks.size()) {
+    _system_tracks.resize(system_id + 1);
+  }
+  auto &track = _system_tracks[system_id];
+  if (!track) {
+    track = add_track(name, Category::System);
+  }
+  record(*track, begin, end, thread);
+}
+
+void SystemStats::record_stage(std::type_index stage, time_point begin, time_point end) {
+  auto found = _stage_tracks.find(stage);
+  if (found == _stage_tracks.end()) {
+    found = _stage_tracks.emplace(stage, add_track(type_name(stage), Category::Stage)).first;
+  }
+  record(found->second, begin, end);
+}
+
+void SystemStats::record_commands(time_point begin, time_point end) {
+  record(_commands_track, begin, end);
+}
+
+SystemStats::Summary SystemStats::summarize(const Track &track) const {
+  const auto &samples = track.window.samples;
+  Summary summary {track.name, track.category, samples.size(), 0, 0, 0};
+
+  if (samples.empty()) {
+    return summary;
+  }
+  std::vector<double> sorted = samples;
+  size_t p95_idx = (sorted.size() * 95) / 100;
+  p95_idx = std::min(p95_idx, sorted.size() - 1);
+  std::nth_element(sorted.begin(), sorted.begin() + p95_idx, sorted.end());
+
+  summary.mean = track.window.sum / samples.size();
+  summary.p95 = sorted[p95_idx];
+  summary.max = *std::max_element(samples.begin(), samples.end());
+  return summary;
+}
+
+std::vector<SystemStats::Summary> SystemStats::summaries() const {
+  std::lock_guard lock(*_mutex);
+  std::vector<Summary> ret;
+
+  ret.reserve(_tracks.size());
+  for (const auto &track : _tracks) {
+    ret.push_back(summarize(track));
+  }
+  return ret;
+}
+
+std::optional<SystemStats::Summary> SystemStats::summary(const std::string &name) const {
+  std::lock_guard lock(*_mutex);
+  auto found = std::find_if(_tracks.begin(), _tracks.end(),
+                            [&name](const Track &track) { return track.name == name; });
+
+  if (found == _tracks.end()) {
+    return std::nullopt;
+  }
+  return summarize(*found);
+}
+
+void SystemStats::export_chrome_trace(std::ostream &out) const {
+  std::lock_guard lock(*_mutex);
+  size_t recorded = std::min(_frame_count + 1, _frames.size());
+  size_t first = (_frame_count + 1 > _frames.size()) ? (_frame_count + 1) % _frames.size() : 0;
+  bool first_event = true;
+
+  out << "{\"traceEvents\":[";
+  for (size_t i = 0; i < recorded; ++i) {
+    const Frame &frame = _frames[(first + i) % _frames.size()];
+
+    for (const auto &span : frame.spans) {
+      const Track &track = _tracks[span.track];
+      std::chrono::duration<double, std::micro> ts = span.begin - _epoch;
+      std::chrono::duration<double, std::micro> dur = span.end - span.begin;
+
+      out << (first_event ? "" : ",") << "\n{\"name\":\"";
+      write_escaped(out, track.name);
+      out << "\",\"cat\":\"" << category_name(track.category) << "\",\"ph\":\"X\",\"ts\":"
+          << ts.count() << ",\"dur\":" << dur.count() << ",\"pid\":0,\"tid\":" << span.thread
+          << "}";
+      first_event = false;
+    }
+  }
+  out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+bool SystemStats::export_chrome_trace(const std::string &path) const {
+  std::ofstream file(path);
+
+  if (!file.is_open()) {
+    return false;
+  }
+  export_chrome_trace(file);
+  return file.good();
+}
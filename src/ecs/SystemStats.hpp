@@ -0,0 +1,135 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** System timing statistics
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace cevy::ecs {
+/**
+ * @brief Resource collecting the run time of every stage, system and command flush
+ *
+ * The Scheduler only takes timestamps when this resource is present in the world:
+ * '''
+ * app.init_resource<SystemStats>(120); // keep the last 120 frames
+ * app.resource<SystemStats>().export_at_exit("trace.json");
+ * '''
+ * Each system keeps a rolling window of its durations to report mean, p95 and max.
+ * The spans of the last frames are kept in a ring buffer and can be exported as a
+ * Chrome trace (about:tracing, Perfetto) at any time or when the app exits,
+ * systems run by a TaskPool are reported on the track of their worker thread.
+ */
+class SystemStats {
+  public:
+  using clock = std::chrono::high_resolution_clock;
+  using time_point = clock::time_point;
+
+  enum class Category {
+    Frame,
+    Stage,
+    System,
+    Commands,
+  };
+
+  /// Rolling statistics of a track, durations in milliseconds
+  struct Summary {
+    std::string name;
+    Category category;
+    size_t samples;
+    double mean;
+    double p95;
+    double max;
+  };
+
+  SystemStats(size_t frames = 120, size_t window = 240);
+
+  /// Rolling statistics of every recorded track
+  std::vector<Summary> summaries() const;
+
+  /// Rolling statistics of the track with the given name
+  std::optional<Summary> summary(const std::string &name) const;
+
+  /// Write the frames in the ring buffer as Chrome trace json
+  void export_chrome_trace(std::ostream &out) const;
+
+  /// Write the frames in the ring buffer as Chrome trace json to a file
+  bool export_chrome_trace(const std::string &path) const;
+
+  /// Export the Chrome trace to path when the app exits
+  void export_at_exit(const std::string &path) { _exit_path = path; }
+
+  const std::optional<std::string> &exit_path() const { return _exit_path; }
+
+  /// Number of frames recorded since the creation of the resource
+  size_t frame_count() const { return _frame_count; }
+
+  /// Readable name of a type, without its namespaces
+  static std::string type_name(std::type_index type);
+
+  /* Scheduler interface */
+  void begin_frame(time_point begin);
+  void end_frame(time_point end);
+  void record_system(size_t system_id, const std::string &name, time_point begin, time_point end,
+                     size_t thread = 0);
+  void record_stage(std::type_index stage, time_point begin, time_point end);
+  void record_commands(time_point begin, time_point end);
+
+  protected:
+  struct RollingWindow {
+    std::vector<double> samples;
+    size_t next = 0;
+    double sum = 0;
+
+    void push(double sample, size_t window);
+  };
+
+  struct Track {
+    std::string name;
+    Category category;
+    RollingWindow window;
+  };
+
+  struct Span {
+    size_t track;
+    time_point begin;
+    time_point end;
+    size_t thread;
+  };
+
+  struct Frame {
+    std::vector<Span> spans;
+  };
+
+  size_t add_track(const std::string &name, Category category);
+  void record(size_t track, time_point begin, time_point end, size_t thread = 0);
+  Summary summarize(const Track &track) const;
+
+  /// systems may be recorded from worker threads
+  std::unique_ptr<std::mutex> _mutex = std::make_unique<std::mutex>();
+  size_t _window;
+  time_point _epoch;
+  time_point _frame_begin;
+  std::vector<Track> _tracks;
+  std::vector<std::optional<size_t>> _system_tracks;
+  std::unordered_map<std::type_index, size_t> _stage_tracks;
+  size_t _frame_track;
+  size_t _commands_track;
+
+  std::vector<Frame> _frames;
+  size_t _frame_count = 0;
+  std::optional<std::string> _exit_path;
+};
+} // namespace cevy::ecs
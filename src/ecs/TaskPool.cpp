@@ -0,0 +1,155 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Task pool
+*/
+
+#include "TaskPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+using cevy::ecs::TaskPool;
+
+static thread_local size_t current_thread_index = 0;
+
+struct TaskPool::Shared {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<task> queue;
+  std::vector<std::thread> workers;
+  bool stop = false;
+
+  void work(size_t index) {
+    current_thread_index = index;
+    while (true) {
+      task func;
+      {
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [this] { return stop || !queue.empty(); });
+        if (queue.empty()) {
+          return;
+        }
+        func = std::move(queue.front());
+        queue.pop_front();
+      }
+      func();
+    }
+  }
+};
+
+TaskPool::TaskPool(size_t threads) : _shared(std::make_unique<Shared>()) {
+  threads = std::max<size_t>(threads, 1);
+  for (size_t i = 1; i < threads; ++i) {
+    _shared->workers.emplace_back(&Shared::work, _shared.get(), i);
+  }
+}
+
+TaskPool::TaskPool(TaskPool &&rhs) noexcept = default;
+
+TaskPool &TaskPool::operator=(TaskPool &&rhs) noexcept {
+  std::swap(_shared, rhs._shared);
+  return *this;
+}
+
+TaskPool::~TaskPool() {
+  if (!_shared) {
+    return;
+  }
+  {
+    std::lock_guard lock(_shared->mutex);
+    _shared->stop = true;
+  }
+  _shared->cv.notify_all();
+  for (auto &worker : _shared->workers) {
+    worker.join();
+  }
+}
+
+size_t TaskPool::size() const { return _shared ? _shared->workers.size() + 1 : 1; }
+
+void TaskPool::spawn(task &&func) {
+  if (!_shared || _shared->workers.empty()) {
+    func();
+    return;
+  }
+  {
+    std::lock_guard lock(_shared->mutex);
+    _shared->queue.push_back(std::move(func));
+  }
+  _shared->cv.notify_one();
+}
+
+bool TaskPool::try_run_one() {
+  task func;
+
+  if (!_shared) {
+    return false;
+  }
+  {
+    std::lock_guard lock(_shared->mutex);
+    if (_shared->queue.empty()) {
+      return false;
+    }
+    func = std::move(_shared->queue.front());
+    _shared->queue.pop_front();
+  }
+  func();
+  return true;
+}
+
+void TaskPool::parallel_for(size_t count, size_t grain, const range_task &func) {
+  grain = std::max<size_t>(grain, 1);
+  size_t chunks = std::min(size(), (count + grain - 1) / grain);
+
+  if (chunks <= 1) {
+    if (count) {
+      func(0, count);
+    }
+    return;
+  }
+  size_t chunk = (count + chunks - 1) / chunks;
+  chunk = (chunk + grain - 1) / grain * grain;
+  chunks = (count + chunk - 1) / chunk;
+
+  std::atomic<size_t> remaining = chunks - 1;
+  std::mutex mutex;
+  std::exception_ptr error = nullptr;
+
+  /* the tasks reference this frame, they must all be done before leaving, even on errors */
+  auto run = [&func, &mutex, &error](size_t first, size_t last) {
+    try {
+      func(first, last);
+    } catch (...) {
+      std::lock_guard lock(mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  };
+  for (size_t first = chunk; first < count; first += chunk) {
+    size_t last = std::min(count, first + chunk);
+
+    spawn([&run, &remaining, first, last]() {
+      run(first, last);
+      remaining.fetch_sub(1, std::memory_order_release);
+    });
+  }
+  run(0, chunk);
+  while (remaining.load(std::memory_order_acquire) != 0) {
+    if (!try_run_one()) {
+      std::this_thread::yield();
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+size_t TaskPool::thread_index() { return current_thread_index; }
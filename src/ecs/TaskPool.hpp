@@ -0,0 +1,68 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Task pool
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <thread>
+
+namespace cevy::ecs {
+/**
+ * @brief Resource holding worker threads, used by the Scheduler to run systems in parallel
+ *
+ * The size counts the thread calling run, so a pool of 1 runs everything on the main thread,
+ * which is also the behavior without this resource.
+ * '''
+ * app.init_resource<TaskPool>(4); // main thread + 3 workers
+ * '''
+ * @warning The resource must not be removed while the app is running
+ */
+class TaskPool {
+  public:
+  using task = std::function<void()>;
+  using range_task = std::function<void(size_t first, size_t last)>;
+
+  TaskPool(size_t threads = std::thread::hardware_concurrency());
+  TaskPool(TaskPool &&rhs) noexcept;
+  TaskPool &operator=(TaskPool &&rhs) noexcept;
+  ~TaskPool();
+
+  /// Number of threads running tasks, the calling thread included
+  size_t size() const;
+
+  /// Queue a task to be run by a worker
+  void spawn(task &&func);
+
+  /// Run one queued task on the calling thread, false if the queue was empty
+  bool try_run_one();
+
+  /**
+   * @brief Run func over [0, count) split in ranges, and wait for all of them
+   *
+   * Every range but the last is a multiple of grain, with at most one range per thread.
+   * The calling thread runs the first range, then helps with the queued tasks until done,
+   * so it may be called from a task of this pool.
+   * When ranges throw, every other range still runs, then the first exception is rethrown.
+   * '''
+   * pool.parallel_for(bodies.size(), 1024, [&](size_t first, size_t last) {
+   *   for (size_t i = first; i < last; ++i)
+   *     step(bodies[i]);
+   * });
+   * '''
+   */
+  void parallel_for(size_t count, size_t grain, const range_task &func);
+
+  /// Index of the current thread in its pool, 0 for threads not owned by a pool
+  static size_t thread_index();
+
+  protected:
+  struct Shared;
+  std::unique_ptr<Shared> _shared;
+};
+} // namespace cevy::ecs
@@ -8,14 +8,25 @@
 #include "Time.hpp"
 #include "World.hpp"
 
+#include <utility>
+
+using cevy::ecs::FrameStats;
 using cevy::ecs::Time;
 
-Time::Time() : _first_update(std::chrono::high_resolution_clock::now()) {}
+Time::Time()
+    : _first_update(std::chrono::high_resolution_clock::now()), _last_update(_first_update),
+      _last_update_delta(0) {}
 
 void init_timer(cevy::ecs::World &w) { w.insert_resource<cevy::ecs::Time>(cevy::ecs::Time()); }
 
-void update_timer(cevy::ecs::Resource<Time> time) {
-  time.get().update_with_instant(std::chrono::high_resolution_clock::now());
+void update_timer(cevy::ecs::Resource<Time> time,
+                  std::optional<cevy::ecs::Resource<FrameStats>> stats) {
+  auto now = std::chrono::high_resolution_clock::now();
+
+  if (stats) {
+    stats->get().begin_frame(now);
+  }
+  time.get().update_with_instant(std::move(now));
 }
 
 std::chrono::duration<double, std::ratio<1>> Time::startup() {
@@ -7,8 +7,10 @@
 
 #pragma once
 
+#include "FrameStats.hpp"
 #include "ecs.hpp"
 #include <chrono>
+#include <optional>
 #include <ratio>
 
 namespace cevy::ecs {
@@ -32,4 +34,6 @@ class Time {
 } // namespace cevy::ecs
 
 void init_timer(cevy::ecs::World &w);
-void update_timer(cevy::ecs::Resource<cevy::ecs::Time> time);
+/// Update Time, and the frame times of FrameStats if it is a resource
+void update_timer(cevy::ecs::Resource<cevy::ecs::Time> time,
+                  std::optional<cevy::ecs::Resource<cevy::ecs::FrameStats>> stats);
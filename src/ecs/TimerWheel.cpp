@@ -0,0 +1,107 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Timer wheel
+*/
+
+#include <cmath>
+
+#include "TimerWheel.hpp"
+#include "Time.hpp"
+#include "World.hpp"
+
+using cevy::ecs::TimerId;
+using cevy::ecs::TimerWheel;
+
+TimerWheel::TimerWheel(DurationType resolution) : _resolution(resolution) {}
+
+TimerId TimerWheel::start(Entity entity, DurationType duration, TimerMode mode) {
+  uint64_t length = to_ticks(duration);
+  uint32_t index;
+
+  if (_free.empty()) {
+    index = _timers.size();
+    _timers.push_back(Timer {entity, 0, 0, 0, false});
+  } else {
+    index = _free.back();
+    _free.pop_back();
+  }
+  Timer &timer = _timers[index];
+  timer.entity = entity;
+  timer.expiry = _now + length;
+  timer.period = mode == Repeating ? length : 0;
+  timer.running = true;
+  _running += 1;
+  schedule(index);
+  return TimerId {index, timer.generation};
+}
+
+TimerId TimerWheel::start(Entity entity, double secs, TimerMode mode) {
+  return start(entity, DurationType(secs), mode);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+  if (!running(id)) {
+    return false;
+  }
+  /* the timer stays in its bucket, it is released when the bucket is reached */
+  _timers[id.index].running = false;
+  _timers[id.index].generation += 1;
+  _running -= 1;
+  return true;
+}
+
+bool TimerWheel::running(TimerId id) const {
+  return id.index < _timers.size() && _timers[id.index].running &&
+         _timers[id.index].generation == id.generation;
+}
+
+size_t TimerWheel::size() const { return _running; }
+
+TimerWheel::DurationType TimerWheel::resolution() const { return _resolution; }
+
+void TimerWheel::system(Resource<Time> time, Resource<TimerWheel> wheel,
+                        EventWriter<TimerFinished> finished) {
+  wheel->advance(time->delta(), [&finished](const TimerFinished &timer) { finished.send(timer); });
+}
+
+uint64_t TimerWheel::to_ticks(DurationType duration) const {
+  double ticks = std::ceil(duration.count() / _resolution.count() - epsilon);
+
+  return ticks < 1 ? 1 : static_cast<uint64_t>(ticks);
+}
+
+void TimerWheel::schedule(uint32_t index) {
+  uint64_t expiry = _timers[index].expiry;
+  uint64_t delta = expiry > _now ? expiry - _now : 0;
+  size_t level = 0;
+
+  if (delta >= span(levels)) {
+    /* too far for the wheel: parked in the last bucket it covers, then scheduled again */
+    expiry = _now + span(levels) - 1;
+    delta = span(levels) - 1;
+  }
+  while (delta >= span(level + 1)) {
+    level += 1;
+  }
+  _wheel[level][(expiry >> (bits * level)) % slots].push_back(index);
+}
+
+void TimerWheel::release(uint32_t index) {
+  Timer &timer = _timers[index];
+
+  if (timer.running) {
+    timer.running = false;
+    timer.generation += 1;
+    _running -= 1;
+  }
+  _free.push_back(index);
+}
+
+size_t TimerWheel::repeat(Timer &timer) {
+  size_t times = 1 + (_now - timer.expiry) / timer.period;
+
+  timer.expiry += times * timer.period;
+  return times;
+}
@@ -0,0 +1,203 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Timer wheel
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Entity.hpp"
+#include "Event.hpp"
+#include "ecs.hpp"
+
+namespace cevy::ecs {
+class Time;
+
+/// Handle on a timer of the TimerWheel
+struct TimerId {
+  uint32_t index;
+  uint32_t generation;
+
+  bool operator==(const TimerId &other) const {
+    return index == other.index && generation == other.generation;
+  }
+};
+
+/// Sent when a timer of the TimerWheel expires
+struct TimerFinished {
+  Entity entity;
+  TimerId timer;
+  /// Number of times a repeating timer expired during the last advance
+  size_t times;
+};
+
+/**
+ * @brief Hierarchical timing wheel, for a large number of timers owned by entities
+ *
+ * Unlike engine::Timer, which must be ticked every frame, a timer only registers its
+ * expiry in a bucket of the wheel. Advancing the wheel only touches the timers whose bucket
+ * is reached, so the cost of a frame follows the number of expirations
+ * rather than the number of live timers.
+ * Added as a Resource by the DefaultPlugin, advanced in core_stage::First,
+ * each expiry sends a TimerFinished event.
+ * '''
+ * void fire(Query<Entity, Weapon> weapons, Resource<TimerWheel> wheel) {
+ *   for (auto [e, weapon] : weapons)
+ *     if (weapon.shoot())
+ *       wheel->start(e, weapon.cooldown);
+ * }
+ * '''
+ * The owning entity is not tracked: a timer outlives the entity unless canceled.
+ */
+class TimerWheel {
+  public:
+  using DurationType = std::chrono::duration<double, std::ratio<1>>;
+  enum TimerMode { Once, Repeating };
+
+  /// Duration of a tick of the wheel, timers expire on the first tick after their duration
+  TimerWheel(DurationType resolution = std::chrono::milliseconds(1));
+
+  /// Start a timer of the given duration, owned by entity
+  TimerId start(Entity entity, DurationType duration, TimerMode mode = Once);
+
+  TimerId start(Entity entity, double secs, TimerMode mode = Once);
+
+  /// Stop a timer before it expires, returns false if it was not running
+  bool cancel(TimerId timer);
+
+  /// Whether the timer is running, a timer started Once stops when it expires
+  bool running(TimerId timer) const;
+
+  /// Number of running timers
+  size_t size() const;
+
+  DurationType resolution() const;
+
+  /// Move the wheel forward, func is called with a TimerFinished for each expiry, in order
+  template <typename F>
+  void advance(DurationType delta, F &&func) {
+    _remainder += delta.count() / _resolution.count();
+    /* absorbs the rounding of durations which are multiples of the resolution */
+    auto ticks = static_cast<uint64_t>(_remainder + epsilon);
+
+    _remainder = std::max(0.0, _remainder - ticks);
+    if (ticks >= span(levels)) {
+      rebuild(_now + ticks, func);
+      return;
+    }
+    for (; ticks > 0; --ticks) {
+      step(func);
+    }
+  }
+
+  /// Advance the wheel by the delta of Time, sending the expirations as events
+  static void system(Resource<Time> time, Resource<TimerWheel> wheel,
+                     EventWriter<TimerFinished> finished);
+
+  protected:
+  static constexpr size_t bits = 6;
+  static constexpr size_t slots = 1 << bits;
+  static constexpr size_t levels = 4;
+  static constexpr double epsilon = 1e-6;
+
+  struct Timer {
+    Entity entity;
+    uint64_t expiry;
+    uint64_t period;
+    uint32_t generation;
+    bool running;
+  };
+
+  using Slot = std::vector<uint32_t>;
+
+  /// Number of ticks covered by the first n levels
+  static constexpr uint64_t span(size_t n) { return uint64_t(1) << (bits * n); }
+
+  uint64_t to_ticks(DurationType duration) const;
+  void schedule(uint32_t index);
+  void release(uint32_t index);
+  /// Reschedule a repeating timer, returns how many times it expired up to now
+  size_t repeat(Timer &timer);
+
+  template <typename F>
+  void step(F &func) {
+    _now += 1;
+    for (size_t level = levels - 1; level > 0; --level) {
+      if (_now % span(level) == 0) {
+        Slot &slot = _wheel[level][(_now >> (bits * level)) % slots];
+
+        std::swap(slot, _cascade);
+        for (uint32_t index : _cascade) {
+          schedule(index);
+        }
+        _cascade.clear();
+      }
+    }
+    std::swap(_wheel[0][_now % slots], _expiring);
+    for (uint32_t index : _expiring) {
+      expire(index, func);
+    }
+    _expiring.clear();
+  }
+
+  template <typename F>
+  void expire(uint32_t index, F &func) {
+    Timer &timer = _timers[index];
+
+    if (!timer.running) {
+      return release(index);
+    }
+    if (timer.expiry > _now) {
+      return schedule(index);
+    }
+    TimerFinished finished {timer.entity, TimerId {index, timer.generation}, 1};
+    if (timer.period == 0) {
+      release(index);
+    } else {
+      finished.times = repeat(timer);
+      schedule(index);
+    }
+    func(finished);
+  }
+
+  /// Jump far ahead, expiring every timer due until now
+  template <typename F>
+  void rebuild(uint64_t now, F &func) {
+    _expiring.clear();
+    for (auto &level : _wheel) {
+      for (Slot &slot : level) {
+        _expiring.insert(_expiring.end(), slot.begin(), slot.end());
+        slot.clear();
+      }
+    }
+    std::sort(_expiring.begin(), _expiring.end(), [this](uint32_t lhs, uint32_t rhs) {
+      return _timers[lhs].expiry < _timers[rhs].expiry;
+    });
+    _now = now;
+    std::vector<uint32_t> pending;
+    std::swap(pending, _expiring);
+    for (uint32_t index : pending) {
+      expire(index, func);
+    }
+  }
+
+  DurationType _resolution;
+  double _remainder = 0;
+  uint64_t _now = 0;
+  size_t _running = 0;
+  std::vector<Timer> _timers;
+  std::vector<uint32_t> _free;
+  std::array<std::array<Slot, slots>, levels> _wheel;
+  Slot _cascade;
+  Slot _expiring;
+};
+} // namespace cevy::ecs
@@ -15,7 +15,14 @@ SparseVector<Entity> &World::entities() { return _entities; }
 const SparseVector<Entity> &World::entities() const { return _entities; }
 
 World::EntityWorldRef World::spawn_empty() {
-  size_t pos = _entities.first_free();
+  flush_reserved_entities();
+  size_t pos = _entities.size();
+
+  if (!_free_entities.empty()) {
+    pos = _free_entities.back();
+    _free_entities.pop_back();
+    _reserved_entities.cursor = _free_entities.size();
+  }
   Entity new_e = Entity(pos);
 
   _entities.insert_at(pos, new_e);
@@ -26,11 +33,37 @@ World::EntityWorldRef World::spawn_empty() {
   return ref;
 }
 
+Entity World::reserve_entity() {
+  std::ptrdiff_t cursor = _reserved_entities.cursor.fetch_sub(1);
+
+  if (cursor > 0) {
+    return Entity(_free_entities[cursor - 1]);
+  }
+  return Entity(_entities.size() - cursor);
+}
+
+void World::flush_reserved_entities() {
+  std::ptrdiff_t cursor = _reserved_entities.cursor.load();
+  size_t kept = cursor > 0 ? cursor : 0;
+  size_t first = _entities.size();
+  size_t added = cursor < 0 ? -cursor : 0;
+
+  for (size_t i = kept; i < _free_entities.size(); ++i) {
+    _entities.insert_at(_free_entities[i], Entity(_free_entities[i]));
+  }
+  _free_entities.resize(kept);
+  for (size_t id = first; id < first + added; ++id) {
+    _entities.insert_at(id, Entity(id));
+  }
+  _reserved_entities.cursor = _free_entities.size();
+}
+
 World::EntityWorldRef::operator Entity &() { return entity; };
 
 Entity World::EntityWorldRef::id() { return entity; };
 
 bool World::despawn(const Entity &e) {
+  flush_reserved_entities();
   for (auto const &[type, data] : _components_arrays) {
     std::get<1>(data)(*this, e);
   }
@@ -38,9 +71,27 @@ bool World::despawn(const Entity &e) {
   if (!w)
     return false;
   w = std::nullopt;
+  _free_entities.push_back(e);
+  _reserved_entities.cursor = _free_entities.size();
   return true;
 }
 
+void World::despawn_many(const std::vector<size_t> &entities) {
+  flush_reserved_entities();
+  for (auto const &[type, data] : _components_arrays) {
+    std::get<2>(data)(*this, entities);
+  }
+  for (auto entity : entities) {
+    if (entity < _entities.size() && _entities[entity]) {
+      _entities[entity] = std::nullopt;
+      _free_entities.push_back(entity);
+    }
+  }
+  _reserved_entities.cursor = _free_entities.size();
+}
+
+void World::drop_deferred() { _drop_queue.clear(); }
+
 void World::clear_all() {
   clear_entities();
   clear_resources();
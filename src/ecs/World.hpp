@@ -15,6 +15,7 @@
  * World. Holds the actual components and entities
  */
 
+#include "CommandBuffer.hpp"
 #include "Entity.hpp"
 #include "Event.hpp"
 #include "Resource.hpp"
@@ -22,14 +23,15 @@
 #include "cevy.hpp"
 
 #include <any>
+#include <atomic>
 #include <cstddef>
 #include <functional>
 #include <optional>
-#include <queue>
 #include <tuple>
 #include <type_traits>
 #include <typeindex>
 #include <unordered_map>
+#include <vector>
 
 #include "Query.hpp"
 #include "ecs.hpp"
@@ -48,6 +50,41 @@ struct Or : std::integral_constant<bool, any<T...>()> {};
 
 namespace cevy::ecs {
 class Commands;
+
+/**
+ * @brief Opt-in for components whose destruction is too heavy for the frame
+ *
+ * When a component of such a type is removed or despawned, it is moved to a queue of the
+ * world and destroyed by World::drop_deferred, which the Scheduler calls at the end of
+ * each frame.
+ * '''
+ * template <>
+ * struct cevy::ecs::deferred_drop<Handle<Model>> : std::true_type {};
+ * '''
+ */
+template <class T>
+struct deferred_drop : public std::false_type {};
+
+/**
+ * @brief Opt-in for components whose removals are reported
+ *
+ * When a component of such a type is removed or despawned, its entity is added to the
+ * RemovedComponents resource of the type, if the world holds one. Replacing the component
+ * by another one is not a removal.
+ * '''
+ * template <>
+ * struct cevy::ecs::track_removals<Collider> : std::true_type {};
+ * app.init_resource<RemovedComponents<Collider>>();
+ * '''
+ */
+template <class T>
+struct track_removals : public std::false_type {};
+
+/// Entities whose component T was removed since the last clear, see track_removals
+template <class T>
+struct RemovedComponents {
+  std::vector<Entity> entities;
+};
 } // namespace cevy::ecs
 
 template <class T>
@@ -90,16 +127,43 @@ class cevy::ecs::World {
   };
 
   using erase_access = std::function<void(World &, Entity const &)>;
+  using erase_many_access = std::function<void(World &, const std::vector<size_t> &)>;
   using command = std::function<void(World &)>;
-  using component_data = std::tuple<std::any, erase_access>;
+  using component_data = std::tuple<std::any, erase_access, erase_many_access>;
 
   friend class cevy::ecs::Scheduler;
   friend class cevy::ecs::Commands;
   friend class EntityWorldRef;
   friend class cevy::ecs::EntityCommands;
+  friend class cevy::ecs::CommandBuffer;
 
   private:
-  std::queue<command> _command_queue;
+  CommandBuffer _command_queue;
+
+  /// components waiting to be destroyed at the end of the frame
+  CommandBuffer _drop_queue;
+
+  /// ids of despawned entities, reused by the next spawns
+  std::vector<size_t> _free_entities;
+
+  /**
+   * @brief Entity ids handed out by reserve_entity since the last flush
+   *
+   * The cursor starts at the size of the free list and goes down with each reservation:
+   * while positive it points into the free list, below zero it counts the ids
+   * taken after the last entity.
+   */
+  struct ReservedEntities {
+    std::atomic<std::ptrdiff_t> cursor {0};
+
+    ReservedEntities() = default;
+    ReservedEntities(ReservedEntities &&rhs) noexcept : cursor(rhs.cursor.exchange(0)) {}
+    ReservedEntities &operator=(ReservedEntities &&rhs) noexcept {
+      cursor = rhs.cursor.exchange(0);
+      return *this;
+    }
+  };
+  ReservedEntities _reserved_entities;
 
   /* Bevy-compliant */
   public:
@@ -123,9 +187,36 @@ class cevy::ecs::World {
   /// create a new empty entity
   EntityWorldRef spawn_empty();
 
+  /**
+   * @brief Reserve the id of a new entity without modifying the world
+   *
+   * Safe to call from concurrent systems, the ids of despawned entities are reused first.
+   * The entity is added to the world by the next flush_reserved_entities,
+   * which the Scheduler calls before applying commands.
+   */
+  Entity reserve_entity();
+
+  /// Add the reserved entities to the world
+  void flush_reserved_entities();
+
   /// delete an entity and all its components
   bool despawn(const Entity &entity);
 
+  /// delete entities and all their components, with one pass per component type
+  void despawn_many(const std::vector<size_t> &entities);
+
+  /// Keep a value alive until the end of the frame, see deferred_drop
+  template <typename T>
+  void defer_drop(T &&value) {
+    _drop_queue.custom([value = std::forward<T>(value)](World &) {});
+  }
+
+  /// Destroy the values given to defer_drop
+  void drop_deferred();
+
+  /// Number of values waiting to be destroyed by drop_deferred
+  size_t deferred_drops() const { return _drop_queue.size(); }
+
   /// clears all resources and entities
   void clear_all();
 
@@ -214,13 +305,17 @@ class cevy::ecs::World {
   template <typename T>
   ComponentId init_component() {
     erase_access f_e = [](World &reg, Entity const &Entity) {
+      reg.erase_component(reg.get_components<T>(), Entity);
+    };
+    erase_many_access f_m = [](World &reg, const std::vector<size_t> &entities) {
       auto &cmpnts = reg.get_components<T>();
-      if (Entity < cmpnts.size())
-        cmpnts[Entity] = std::nullopt;
+      for (auto entity : entities) {
+        reg.erase_component(cmpnts, entity);
+      }
     };
     std::any a = std::make_any<SparseVector<T>>();
 
-    _components_arrays.insert({std::type_index(typeid(T)), std::make_tuple(a, f_e)});
+    _components_arrays.insert({std::type_index(typeid(T)), std::make_tuple(a, f_e, f_m)});
 
     return std::type_index(typeid(T));
   };
@@ -245,7 +340,7 @@ class cevy::ecs::World {
     auto it = _components_arrays.find(id);
 
     if (it != _components_arrays.end()) {
-      return std::any_cast<SparseVector<Component> &>(std::get<0>(_components_arrays[id]));
+      return std::any_cast<SparseVector<Component> &>(std::get<0>(it->second));
     }
     throw(std::runtime_error(
         std::string("Cevy/Ecs: Get unregisted component! ID: ").append(typeid(Component).name())));
@@ -257,7 +352,7 @@ class cevy::ecs::World {
     auto it = _components_arrays.find(id);
 
     if (it != _components_arrays.end()) {
-      return std::any_cast<SparseVector<Component> &>(std::get<0>(_components_arrays.at(id)));
+      return std::any_cast<SparseVector<Component> &>(std::get<0>(it->second));
     }
     throw(std::runtime_error(
         std::string("Cevy/Ecs: Get unregisted component! ID: ").append(typeid(Component).name())));
@@ -267,9 +362,33 @@ class cevy::ecs::World {
   /// @deprecated No usage found
   template <typename Component>
   void remove_component(Entity const &from) {
-    auto &array = get_components<Component>();
-    if (from < array.size())
-      array.erase(from);
+    erase_component(get_components<Component>(), from);
+  }
+
+  /// Remove the component of an entity, reporting it if asked by its type
+  template <typename Component>
+  void erase_component(SparseVector<Component> &array, size_t entity) {
+    if (entity >= array.size() || !array[entity]) {
+      return;
+    }
+    if constexpr (track_removals<Component>::value) {
+      if (contains_resource<RemovedComponents<Component>>()) {
+        resource<RemovedComponents<Component>>().entities.push_back(Entity(entity));
+      }
+    }
+    drop_component(array, entity);
+  }
+
+  /// Erase the component of an entity, its destruction is deferred if asked by its type
+  template <typename Component>
+  void drop_component(SparseVector<Component> &array, size_t entity) {
+    if (entity >= array.size() || !array[entity]) {
+      return;
+    }
+    if constexpr (deferred_drop<Component>::value) {
+      defer_drop(std::move(*array[entity]));
+    }
+    array.erase(entity);
   }
 
   /// get a Component T associated with a given Entity, or Nothing if no such
@@ -326,28 +445,20 @@ class cevy::ecs::World {
     return Q::query(*this);
   }
 
+  /// reads every stored event, the Scheduler gives its systems a cursor with read_events
   template <typename R, typename std::enable_if_t<is_event_reader<R>::value, bool> = true>
   R get_super(size_t) {
-    if (!contains_resource<Event<typename R::value_type>>())
-      throw(std::runtime_error("Cevy/Ecs: Tried to use EventReader on an unregisted event!"));
+    size_t cursor = 0;
 
-    return EventReader(resource<Event<typename R::value_type>>());
+    return read_events<typename R::value_type>(cursor);
   }
 
   template <typename W, typename std::enable_if_t<is_event_writer<W>::value, bool> = true>
-  W get_super(size_t system_id) {
+  W get_super(size_t) {
     if (!contains_resource<Event<typename W::value_type>>())
       throw(std::runtime_error("Cevy/Ecs: Tried to use EventWriter on an unregisted event!"));
 
-    auto &res = resource<Event<typename W::value_type>>();
-
-    if (res.event_queue.empty())
-      return EventWriter(res, system_id);
-
-    for (int i = res.event_queue.size() - 1; i >= 0; i--)
-      if (std::get<1>(res.event_queue.at(i)) == system_id)
-        res.event_queue.erase(res.event_queue.begin() + i);
-    return EventWriter(res, system_id);
+    return EventWriter(resource<Event<typename W::value_type>>());
   }
 
   template <typename R, typename std::enable_if_t<is_resource<R>::value, bool> = true,
@@ -360,7 +471,7 @@ class cevy::ecs::World {
             typename std::enable_if_t<is_resource<R>::value, bool> = true,
             typename std::enable_if_t<is_optional<OR>::value, bool> = true>
   OR get_super(size_t) {
-    return _resource_manager.get_resource<R>();
+    return _resource_manager.get_resource<typename R::value>();
   }
 
   template <typename C, typename std::enable_if_t<is_commands<C>::value, bool> = true>
@@ -387,6 +498,19 @@ class cevy::ecs::World {
   //   sys();
   // }
   public:
+  /// Reader of the events of T sent since cursor, which is moved past them
+  template <typename T>
+  EventReader<T> read_events(size_t &cursor) {
+    if (!contains_resource<Event<T>>())
+      throw(std::runtime_error("Cevy/Ecs: Tried to use EventReader on an unregisted event!"));
+
+    auto &events = resource<Event<T>>();
+    EventReader<T> reader(events, cursor);
+
+    cursor = events.next_id();
+    return reader;
+  }
+
   template <class R, class... Args>
   R run_system(std::function<R(Args...)> func) {
     static_assert(
@@ -459,6 +583,32 @@ class cevy::ecs::World {
   // }
 };
 
+template <typename T>
+void cevy::ecs::CommandBuffer::apply_typed(World &world, Header *const *records, size_t count) {
+  auto &array = world.get_components<T>();
+  size_t size = array.size();
+
+  for (size_t i = 0; i < count; ++i) {
+    if (records[i]->meta->op == Op::Insert && records[i]->entity >= size) {
+      size = records[i]->entity + 1;
+    }
+  }
+  if (size > array.size()) {
+    array.resize(size);
+  }
+  for (size_t i = 0; i < count; ++i) {
+    size_t entity = records[i]->entity;
+
+    if (records[i]->meta->op == Op::Remove) {
+      world.erase_component(array, entity);
+    } else if (entity < world._entities.size() && world._entities[entity]) {
+      /* a despawned entity does not get components back, its id may be reused */
+      world.drop_component(array, entity);
+      array.insert_at(entity, std::move(*static_cast<T *>(payload_of(records[i]))));
+    }
+  }
+}
+
 template <typename... Ts>
 cevy::ecs::World::EntityWorldRef cevy::ecs::World::EntityWorldRef::insert(Ts... args) {
   (world.add_component(entity, std::forward<Ts>(args)), ...);
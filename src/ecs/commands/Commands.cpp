@@ -13,8 +13,10 @@ using cevy::ecs::EntityCommands;
 #include "ecs.hpp"
 
 void cevy::ecs::Commands::add(std::function<void(cevy::ecs::World &w)> &&f) {
-  _world_access._command_queue.push(f);
+  buffer().custom(std::move(f));
 }
 
 EntityCommands Commands::entity(const cevy::ecs::Entity &e) { return EntityCommands(*this, e); }
-void cevy::ecs::Commands::despawn(Entity e) { _world_access.despawn(e); }
+void cevy::ecs::Commands::despawn(Entity e) {
+  buffer().despawn(e);
+}
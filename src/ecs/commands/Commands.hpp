@@ -18,19 +18,46 @@ class EntityCommands;
 }
 } // namespace cevy
 
+/**
+ * @brief System parameter deferring changes to the world
+ *
+ * Each system taking Commands owns a command buffer, so systems running concurrently
+ * never share one. The Scheduler applies the buffers at the end of the stage,
+ * in the registration order of the systems.
+ * Spawned entities get their id right away, it is reserved without touching the world.
+ *
+ * system() and system_with() run immediately on the world: a system calling them
+ * should take World & instead, to be run alone.
+ */
 class cevy::ecs::Commands {
   protected:
   friend class cevy::ecs::World;
+  friend class cevy::ecs::Scheduler;
+  friend class cevy::ecs::EntityCommands;
 
   cevy::ecs::World &_world_access;
-  Commands(cevy::ecs::World &world_access) : _world_access(world_access) {};
+  cevy::ecs::CommandBuffer &_buffer;
+  Commands(cevy::ecs::World &world_access)
+      : _world_access(world_access), _buffer(world_access._command_queue) {};
+  Commands(cevy::ecs::World &world_access, cevy::ecs::CommandBuffer &buffer)
+      : _world_access(world_access), _buffer(buffer) {};
+
+  cevy::ecs::CommandBuffer &buffer() { return _buffer; }
 
   public:
   template <typename GivenCommand,
             typename std::enable_if_t<std::is_base_of_v<Command, GivenCommand>, bool> = true>
   void add(const GivenCommand &a) {
-    auto l = [a](cevy::ecs::World &w) { a.apply(w); };
-    _world_access._command_queue.push(l);
+    buffer().custom([a](cevy::ecs::World &w) { a.apply(w); });
+  }
+
+  /// Queue any callable taking the world, it is stored inline in the command buffer
+  template <typename F,
+            typename std::enable_if_t<std::is_invocable_v<F &, cevy::ecs::World &> &&
+                                          !std::is_base_of_v<Command, std::decay_t<F>>,
+                                      bool> = true>
+  void add(F &&f) {
+    buffer().custom(std::forward<F>(f));
   }
 
   void add(std::function<void(cevy::ecs::World &w)> &&f);
@@ -8,10 +8,8 @@
 #include "EntityCommands.hpp"
 
 cevy::ecs::EntityCommands cevy::ecs::Commands::spawn_empty() {
-  size_t pos = _world_access._entities.first_free(); // Should be check when multithreading
-  Entity new_e = Entity(pos);
+  Entity new_e = _world_access.reserve_entity();
 
-  _world_access._entities.insert_at(pos, new_e);
   return (cevy::ecs::EntityCommands(*this, new_e));
 }
 
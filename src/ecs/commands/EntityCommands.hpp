@@ -22,15 +22,13 @@ class cevy::ecs::EntityCommands {
   public:
   template <typename... Components>
   cevy::ecs::EntityCommands &insert(const Components &...c) {
-    _commands.add(
-        [c..., e = _entity](cevy::ecs::World &w) mutable { (w.add_component(e, c), ...); });
+    (_commands.buffer().insert(_entity, c), ...);
     return *this;
   }
 
   template <typename... Components>
   cevy::ecs::EntityCommands &remove() {
-    _commands.add(
-        [e = _entity](cevy::ecs::World &w) mutable { (w.remove_component<Components>(e), ...); });
+    (_commands.buffer().remove<Components>(_entity), ...);
     return *this;
   }
 
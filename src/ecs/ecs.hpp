@@ -23,6 +23,7 @@ class Plugin;
 class Scheduler;
 class Commands;
 class Command;
+class CommandBuffer;
 class EntityCommands;
 class World;
 
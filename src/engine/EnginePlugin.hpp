@@ -14,6 +14,7 @@
 #include "Color.hpp"
 #include "DefaultPlugin.hpp"
 #include "ForwardRenderer.hpp"
+#include "Hierarchy.hpp"
 #include "Line.hpp"
 #include "PhysicsProps.hpp"
 #include "Plugin.hpp"
@@ -46,12 +47,15 @@ class Engine : public cevy::ecs::Plugin {
 #endif
     app.init_resource<cevy::engine::Atmosphere>();
     app.init_resource<cevy::engine::Window>(Windower<Renderer>(1280, 720));
+    app.init_resource<cevy::engine::VelocityIntegrator>();
     app.init_component<cevy::engine::Camera>();
     app.init_component<cevy::engine::Velocity>();
     app.init_component<cevy::engine::PhysicsProps>();
     app.init_component<cevy::engine::Target>();
     app.init_component<cevy::engine::Line>();
     app.init_component<cevy::engine::Parent>();
+    app.init_component<cevy::engine::Children>();
+    app.init_component<cevy::engine::GlobalTransform>();
     app.init_component<cevy::engine::Transform>();
     app.init_component<cevy::engine::TransformVelocity>();
     app.init_component<cevy::engine::PointLight>();
@@ -62,7 +66,9 @@ class Engine : public cevy::ecs::Plugin {
     app.add_plugins(typename Windower<Renderer>::Plugin());
     app.add_systems<cevy::engine::PreRenderStage>(update_camera);
     app.add_systems<ecs::core_stage::PostUpdate>(TransformVelocity::system);
-    app.add_systems<cevy::ecs::core_stage::PreUpdate>(Transform::children_system);
+    app.add_systems<cevy::ecs::core_stage::PreUpdate>(Hierarchy::sync_children,
+                                                      Hierarchy::propagate)
+        .chain();
   };
 };
 } // namespace cevy::engine
@@ -0,0 +1,94 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** GlobalTransform
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Transform.hpp"
+
+namespace cevy::engine {
+/**
+ * @brief World transform of an entity, with its matrix
+ *
+ * Added and updated by Hierarchy::propagate, only when the Transform of the entity,
+ * its Parent, or the GlobalTransform of its parent changed since the last propagation.
+ * Read it rather than recomputing Transform::get_world().mat4().
+ */
+class GlobalTransform {
+  public:
+  GlobalTransform() : _world(), _matrix(1) {}
+
+  const glm::mat4 &mat4() const { return _matrix; }
+  operator const glm::mat4 &() const { return _matrix; }
+
+  const glm::vec3 &position() const { return _world.position; }
+  const glm::quat &rotation() const { return _world.rotation; }
+  const glm::vec3 &scale() const { return _world.scale; }
+
+  /// World transform, as a Transform without parent
+  const Transform &transform() const { return _world; }
+
+  protected:
+  friend class Hierarchy;
+
+  static constexpr size_t no_parent = size_t(-1);
+
+  /// Whether local, or the parent, differs from the last update
+  bool changed(const Transform &local, size_t parent) const {
+    return !_valid || _parent != parent || local.position != _local_position ||
+           local.rotation != _local_rotation || local.scale != _local_scale;
+  }
+
+  /// Compute the world transform of local, relative to parent if any
+  void update(Transform &local, const GlobalTransform *parent, size_t parent_id) {
+    if (parent) {
+      local.parent(parent->_world);
+    } else {
+      local.reset_world();
+    }
+    _world = local.get_world();
+    _matrix = _world.mat4();
+    _local_position = local.position;
+    _local_rotation = local.rotation;
+    _local_scale = local.scale;
+    _parent = parent_id;
+    _valid = true;
+  }
+
+  Transform _world;
+  glm::mat4 _matrix;
+
+  /* local transform and parent of the last update */
+  glm::vec3 _local_position;
+  glm::quat _local_rotation;
+  glm::vec3 _local_scale;
+  size_t _parent = no_parent;
+  bool _valid = false;
+};
+
+/// World matrix of an entity, from its Transform if it was not propagated yet
+inline glm::mat4 world_matrix(const std::optional<Transform> &local,
+                              const std::optional<GlobalTransform> &global) {
+  if (!local) {
+    return glm::mat4(1);
+  }
+  return global ? global->mat4() : local->get_world().mat4();
+}
+
+/// World position of an entity, from its Transform if it was not propagated yet
+inline glm::vec3 world_position(const std::optional<Transform> &local,
+                                const std::optional<GlobalTransform> &global) {
+  if (!local) {
+    return glm::vec3();
+  }
+  return global ? global->position() : local->get_world().position;
+}
+} // namespace cevy::engine
@@ -0,0 +1,132 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Hierarchy
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "Entity.hpp"
+#include "GlobalTransform.hpp"
+#include "Query.hpp"
+#include "Transform.hpp"
+#include "cevy.hpp"
+
+namespace cevy::engine {
+/**
+ * @brief Children of an entity, kept in sync with the Parent components
+ *
+ * Rebuilt by Hierarchy::sync_children at the start of PreUpdate, in entity order:
+ * set or remove a Parent to change the hierarchy, not the Children.
+ * Only entities with a Transform are tracked.
+ */
+struct Children {
+  std::vector<ecs::Entity> entities;
+
+  std::vector<ecs::Entity>::const_iterator begin() const { return entities.begin(); }
+  std::vector<ecs::Entity>::const_iterator end() const { return entities.end(); }
+  size_t size() const { return entities.size(); }
+  bool empty() const { return entities.empty(); }
+};
+
+/**
+ * @brief Systems maintaining the Children lists and the world transforms
+ *
+ * The world transform of every root, an entity without Parent, is its local transform.
+ * It is then propagated breadth first, each transform being computed at most once from the
+ * world transform of its parent, and kept in the GlobalTransform of the entity.
+ * An entity whose parent has no Transform is a root, entities in a parenting cycle are skipped.
+ */
+class Hierarchy {
+  public:
+  using Nodes = ecs::Query<ecs::Entity, Transform, option<Children>>;
+  using Tree = ecs::Query<ecs::Entity, Transform, option<Parent>, option<Children>,
+                          option<GlobalTransform>>;
+
+  /// Rebuild the Children of every entity with a Transform from the Parent components
+  static void sync_children(ecs::Query<ecs::Entity, Parent> parented, Nodes nodes) {
+    for (auto [entity, transform, children] : nodes) {
+      if (children) {
+        children->entities.clear();
+      }
+    }
+    for (auto [entity, parent] : parented) {
+      auto node = nodes.from(parent.entity);
+
+      if (node == nodes.end() || node.index() != size_t(parent.entity)) {
+        continue;
+      }
+      auto &children = std::get<2>(*node);
+      if (!children) {
+        children.emplace();
+      }
+      children->entities.push_back(entity);
+    }
+    for (auto [entity, transform, children] : nodes) {
+      if (children && children->empty()) {
+        children.reset();
+      }
+    }
+  }
+
+  /**
+   * @brief Compute the world transforms which changed, parents first
+   *
+   * Every entity is visited, but the world transform and matrix of an entity are only
+   * computed again if its Transform or Parent changed, or if its parent was computed again.
+   */
+  static void propagate(Tree tree) {
+    std::vector<std::pair<size_t, bool>> queue;
+
+    for (auto [entity, transform, parent, children, global] : tree) {
+      if (parent && is_node(tree, parent->entity)) {
+        continue;
+      }
+      bool dirty = refresh(transform, global, nullptr, GlobalTransform::no_parent, false);
+      if (children) {
+        queue.emplace_back(entity, dirty);
+      }
+    }
+    for (size_t i = 0; i < queue.size(); ++i) {
+      auto [parent_id, parent_dirty] = queue[i];
+      auto [entity, transform, parent, children, global] = *tree.from(parent_id);
+
+      for (auto child : *children) {
+        if (!is_node(tree, child)) {
+          continue;
+        }
+        auto [_, child_transform, child_parent, grandchildren, child_global] = *tree.from(child);
+        bool dirty = refresh(child_transform, child_global, &*global, parent_id, parent_dirty);
+        if (grandchildren) {
+          queue.emplace_back(child, dirty);
+        }
+      }
+    }
+  }
+
+  protected:
+  /// Update global if forced or if it changed, returns whether it was updated
+  static bool refresh(Transform &local, option<GlobalTransform> &global,
+                      const GlobalTransform *parent, size_t parent_id, bool force) {
+    if (!global) {
+      global.emplace();
+    }
+    if (!force && !global->changed(local, parent_id)) {
+      return false;
+    }
+    global->update(local, parent, parent_id);
+    return true;
+  }
+
+  static bool is_node(Tree &tree, size_t slot) {
+    auto node = tree.from(slot);
+
+    return node != tree.end() && node.index() == slot;
+  }
+};
+} // namespace cevy::engine
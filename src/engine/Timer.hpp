@@ -17,6 +17,7 @@
 namespace cevy {
 namespace engine {
 
+/// Ticked by its owner every frame, for many timers owned by entities see ecs::TimerWheel
 class Timer {
   public:
   enum TimerMode { Once, Repeating };
@@ -11,11 +11,14 @@
 #include "Query.hpp"
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
-#include <map>
 
 namespace cevy {
 namespace engine {
 
+class Hierarchy;
+class GlobalTransform;
+
+/// Makes the Transform of the entity relative to the one of its parent, see Hierarchy
 struct Parent {
   ecs::Entity entity;
 };
@@ -285,6 +288,8 @@ class Transform {
   protected:
   template <template <typename T> typename Windower, typename Renderer>
   friend class Engine;
+  friend class Hierarchy;
+  friend class GlobalTransform;
 
   Transform &parent(const Transform &parent) {
     auto world = parent.get_world();
@@ -311,39 +316,6 @@ class Transform {
   glm::vec3 world_position;
   glm::quat world_rotation;
   glm::vec3 world_scale;
-
-  static void parent_callback(std::map<size_t, std::tuple<Transform *, size_t>> storage,
-                              Transform &self, size_t parent) {
-    if (storage.find(parent) != storage.end()) {
-      auto &[p_tm, p_p] = storage.at(parent);
-      // std::get<1>(storage.at(parent)) = size_t(-1);
-      p_p = size_t(-1);
-      parent_callback(storage, *p_tm, p_p);
-      self.parent(*p_tm);
-    }
-  };
-
-  static int children_system(ecs::Query<cevy::ecs::Entity, Parent, Transform> children,
-                             ecs::Query<ecs::Entity, Transform> all) {
-    std::map<size_t, std::tuple<Transform *, size_t>> storage;
-    for (auto [c_en, parent, c_tm] : children) {
-      c_tm.reset_world();
-      storage[c_en] = std::make_tuple(&c_tm, size_t(parent.entity));
-      if (storage.find(parent.entity) == storage.end()) {
-        auto q_parent = all.get(parent.entity);
-        if (q_parent) {
-          auto [_, p_tm] = q_parent.value();
-          p_tm.reset_world();
-          storage[parent.entity] = std::make_tuple(&p_tm, size_t(-1));
-        }
-      }
-    }
-    for (auto [en, s] : storage) {
-      auto [tm, p] = s;
-      parent_callback(storage, *tm, p);
-    }
-    return 0;
-  }
 };
 } // namespace engine
 } // namespace cevy
@@ -11,9 +11,12 @@
 #include "Query.hpp"
 #include "Resource.hpp"
 #include "Time.hpp"
+#include "TaskPool.hpp"
 #include "Transform.hpp"
+#include "VelocityIntegrator.hpp"
 #include <glm/ext/quaternion_geometric.hpp>
 #include <glm/ext/vector_float3.hpp>
+#include <optional>
 
 namespace cevy::engine {
 class Velocity : public glm::vec3 {
@@ -55,21 +58,18 @@ class TransformVelocity : public engine::Transform {
   protected:
   template <template <typename> typename Windower, typename Renderer>
   friend class Engine;
+  /// Integrate every TransformVelocity, see VelocityIntegrator
   static void
   system(ecs::Query<engine::Transform, TransformVelocity, option<cevy::engine::PhysicsProps>> q,
-         ecs::Resource<cevy::ecs::Time> time) {
-    float delta_t = time.get().delta_seconds();
+         ecs::Resource<cevy::ecs::Time> time, ecs::Resource<VelocityIntegrator> integrator,
+         std::optional<ecs::Resource<ecs::TaskPool>> pool) {
+    auto &bodies = integrator.get();
+
+    bodies.clear();
     for (auto [tm, vel, phys] : q) {
-      auto scaled = vel * delta_t;
-      tm.position += scaled.position;
-      tm.rotation *= scaled.rotation;
-      tm.scale *= scaled.scale;
-      float decay = 1;
-      if (phys.has_value()) {
-        decay = 1 - phys.value().decay;
-        vel *= powf(decay, delta_t);
-      }
+      bodies.push(tm, vel, phys ? phys->decay : 0);
     }
+    bodies.integrate(time.get().delta_seconds(), pool ? &pool->get() : nullptr);
   }
 
   private:
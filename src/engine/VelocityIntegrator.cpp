@@ -0,0 +1,312 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Velocity integrator
+*/
+
+#include "VelocityIntegrator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/quaternion.hpp>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+using cevy::engine::Transform;
+using cevy::engine::VelocityIntegrator;
+
+void VelocityIntegrator::clear() { _bodies.clear(); }
+
+void VelocityIntegrator::push(Transform &transform, Transform &velocity, float decay) {
+  _bodies.push_back(Body {&transform, &velocity, decay});
+}
+
+void VelocityIntegrator::integrate(float delta, ecs::TaskPool *pool) {
+  if (pool && pool->size() > 1 && size() >= parallel_threshold) {
+    pool->parallel_for(size(), grain, [this, delta](size_t first, size_t last) {
+      integrate_range(first, last, delta);
+    });
+  } else {
+    integrate_range(0, size(), delta);
+  }
+}
+
+void VelocityIntegrator::integrate_one(Transform &transform, Transform &velocity, float decay,
+                                       float delta) {
+  transform.position += velocity.position * delta;
+  transform.rotation *= glm::slerp(glm::identity<glm::quat>(), velocity.rotation, delta);
+  transform.scale *= glm::pow(velocity.scale, glm::vec3(delta, delta, delta));
+  if (decay != 0) {
+    float factor = powf(1 - decay, delta);
+
+    velocity.position *= factor;
+    velocity.rotation = glm::slerp(glm::identity<glm::quat>(), velocity.rotation, factor);
+    velocity.scale = glm::pow(velocity.scale, glm::vec3(factor, factor, factor));
+  }
+}
+
+void VelocityIntegrator::integrate_range(size_t first, size_t last, float delta) {
+  size_t body = first;
+
+#ifdef __AVX__
+  /* the approximations of the batches hold for a slerp factor within [0, 1] */
+  if (delta >= 0 && delta <= 1) {
+    for (; body + lanes <= last; body += lanes) {
+      integrate_batch(body, delta);
+    }
+  }
+#endif
+  for (; body < last; ++body) {
+    integrate_one(*_bodies[body].transform, *_bodies[body].velocity, _bodies[body].decay, delta);
+  }
+}
+
+#ifdef __AVX__
+namespace {
+struct Lanes {
+  __m256 position[3];
+  __m256 rotation[4];
+  __m256 scale[3];
+};
+
+inline __m256 set(float value) { return _mm256_set1_ps(value); }
+inline __m256 add(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+inline __m256 sub(__m256 a, __m256 b) { return _mm256_sub_ps(a, b); }
+inline __m256 mul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+
+/// p[0] * x^(N - 1) + ... + p[N - 1]
+template <size_t N>
+inline __m256 polynomial(__m256 x, const float (&p)[N]) {
+  __m256 y = set(p[0]);
+
+  for (size_t i = 1; i < N; ++i) {
+    y = add(mul(y, x), set(p[i]));
+  }
+  return y;
+}
+
+/* AVX has no 256 bit integer shifts, they are done on each half */
+inline __m256i shift_left_23(__m256i bits) {
+  __m128i low = _mm_slli_epi32(_mm256_castsi256_si128(bits), 23);
+  __m128i high = _mm_slli_epi32(_mm256_extractf128_si256(bits, 1), 23);
+
+  return _mm256_insertf128_si256(_mm256_castsi128_si256(low), high, 1);
+}
+
+inline __m256i shift_right_23(__m256i bits) {
+  __m128i low = _mm_srli_epi32(_mm256_castsi256_si128(bits), 23);
+  __m128i high = _mm_srli_epi32(_mm256_extractf128_si256(bits, 1), 23);
+
+  return _mm256_insertf128_si256(_mm256_castsi128_si256(low), high, 1);
+}
+
+/// e^x, cephes expf
+inline __m256 exp(__m256 x) {
+  static constexpr float p[] = {1.9875691500E-4, 1.3981999507E-3, 8.3334519073E-3,
+                                4.1665795894E-2, 1.6666665459E-1, 5.0000001201E-1};
+
+  x = _mm256_min_ps(_mm256_max_ps(x, set(-87.f)), set(88.f));
+  __m256 n = _mm256_floor_ps(add(mul(x, set(1.44269504088896341f)), set(0.5f)));
+  x = sub(x, mul(n, set(0.693359375f)));
+  x = sub(x, mul(n, set(-2.12194440e-4f)));
+
+  __m256 y = add(add(mul(polynomial(x, p), mul(x, x)), x), set(1));
+  __m256i exponent = shift_left_23(_mm256_cvttps_epi32(add(n, set(127))));
+  return mul(y, _mm256_castsi256_ps(exponent));
+}
+
+/// natural logarithm of x > 0, cephes logf
+inline __m256 log(__m256 x) {
+  static constexpr float p[] = {7.0376836292E-2,  -1.1514610310E-1, 1.1676998740E-1,
+                                -1.2420140846E-1, 1.4249322787E-1,  -1.6668057665E-1,
+                                2.0000714765E-1,  -2.4999993993E-1, 3.3333331174E-1};
+
+  x = _mm256_max_ps(x, set(1.17549435e-38f));
+  __m256i bits = _mm256_castps_si256(x);
+  __m256 e = sub(_mm256_cvtepi32_ps(shift_right_23(bits)), set(126));
+
+  /* mantissa within [0.5, 1), then [sqrt(1/2) - 1, sqrt(2) - 1) */
+  x = _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(~0x7f800000)));
+  x = _mm256_or_ps(x, set(0.5f));
+  __m256 below = _mm256_cmp_ps(x, set(0.707106781186547524f), _CMP_LT_OQ);
+  e = sub(e, _mm256_and_ps(set(1), below));
+  x = add(sub(x, set(1)), _mm256_and_ps(x, below));
+
+  __m256 z = mul(x, x);
+  __m256 y = mul(mul(polynomial(x, p), x), z);
+  y = add(y, mul(e, set(-2.12194440e-4f)));
+  y = sub(y, mul(z, set(0.5f)));
+  return add(add(x, y), mul(e, set(0.693359375f)));
+}
+
+/// x^t of x >= 0, from log(x): log clamps 0 to the smallest float, but 0^t is 0 for t > 0
+inline __m256 pow(__m256 x, __m256 log_x, __m256 t) {
+  __m256 zero =
+      _mm256_and_ps(_mm256_cmp_ps(x, set(0), _CMP_EQ_OQ), _mm256_cmp_ps(t, set(0), _CMP_GT_OQ));
+
+  return _mm256_andnot_ps(zero, exp(mul(log_x, t)));
+}
+
+/// acos of x within [0, 1], Abramowitz & Stegun 4.4.46
+inline __m256 acos(__m256 x) {
+  static constexpr float p[] = {-0.0012624911f, 0.0066700901f,  -0.0170881256f, 0.0308918810f,
+                                -0.0501743046f, 0.0889789874f,  -0.2145988016f, 1.5707963050f};
+
+  return mul(_mm256_sqrt_ps(_mm256_max_ps(sub(set(1), x), set(0))), polynomial(x, p));
+}
+
+/// sin and cos of x within [0, pi / 2], by their Taylor series
+inline void sincos(__m256 x, __m256 &sin, __m256 &cos) {
+  static constexpr float sin_p[] = {-1.f / 39916800, 1.f / 362880, -1.f / 5040, 1.f / 120,
+                                    -1.f / 6,        1};
+  static constexpr float cos_p[] = {-1.f / 3628800, 1.f / 40320, -1.f / 720, 1.f / 24,
+                                    -1.f / 2,       1};
+  __m256 x2 = mul(x, x);
+
+  sin = mul(polynomial(x2, sin_p), x);
+  cos = polynomial(x2, cos_p);
+}
+
+/// slerp from identity to the unit quaternions q, by t within [0, 1]
+inline void slerp(const __m256 (&q)[4], __m256 t, __m256 (&out)[4]) {
+  /* take the shortest path, as glm does */
+  __m256 sign = _mm256_and_ps(q[0], set(-0.f));
+  __m256 w = _mm256_min_ps(_mm256_xor_ps(q[0], sign), set(1));
+  __m256 norm = _mm256_sqrt_ps(add(add(mul(q[1], q[1]), mul(q[2], q[2])), mul(q[3], q[3])));
+
+  /* half angle, from the smallest of w and |xyz| for precision at small angles */
+  __m256 small = _mm256_cmp_ps(norm, w, _CMP_LT_OQ);
+  __m256 angle = _mm256_blendv_ps(acos(w), sub(set(1.57079632679f), acos(norm)), small);
+
+  __m256 sin;
+  __m256 cos;
+  sincos(mul(t, angle), sin, cos);
+
+  /* sin(t * angle) / sin(angle), which tends to t */
+  __m256 tiny = _mm256_cmp_ps(norm, set(1e-6f), _CMP_LT_OQ);
+  __m256 ratio = _mm256_blendv_ps(_mm256_div_ps(sin, _mm256_max_ps(norm, set(1e-6f))), t, tiny);
+  ratio = _mm256_xor_ps(ratio, sign);
+
+  out[0] = cos;
+  for (size_t i = 1; i < 4; ++i) {
+    out[i] = mul(q[i], ratio);
+  }
+}
+
+/// Hamilton product a * b, in w x y z order
+inline void multiply(const __m256 (&a)[4], const __m256 (&b)[4], __m256 (&out)[4]) {
+  out[0] = sub(sub(sub(mul(a[0], b[0]), mul(a[1], b[1])), mul(a[2], b[2])), mul(a[3], b[3]));
+  out[1] = sub(add(add(mul(a[0], b[1]), mul(a[1], b[0])), mul(a[2], b[3])), mul(a[3], b[2]));
+  out[2] = sub(add(add(mul(a[0], b[2]), mul(a[2], b[0])), mul(a[3], b[1])), mul(a[1], b[3]));
+  out[3] = sub(add(add(mul(a[0], b[3]), mul(a[3], b[0])), mul(a[1], b[2])), mul(a[2], b[1]));
+}
+
+template <typename Get>
+inline __m256 gather(Get &&get) {
+  alignas(32) float lanes[VelocityIntegrator::lanes];
+
+  for (size_t lane = 0; lane < VelocityIntegrator::lanes; ++lane) {
+    lanes[lane] = get(lane);
+  }
+  return _mm256_load_ps(lanes);
+}
+
+template <typename Get>
+inline void load(Lanes &out, Get &&get) {
+  for (size_t i = 0; i < 3; ++i) {
+    out.position[i] = gather([&](size_t lane) { return get(lane).position[i]; });
+    out.scale[i] = gather([&](size_t lane) { return get(lane).scale[i]; });
+  }
+  out.rotation[0] = gather([&](size_t lane) { return get(lane).rotation.w; });
+  out.rotation[1] = gather([&](size_t lane) { return get(lane).rotation.x; });
+  out.rotation[2] = gather([&](size_t lane) { return get(lane).rotation.y; });
+  out.rotation[3] = gather([&](size_t lane) { return get(lane).rotation.z; });
+}
+
+template <typename Get>
+inline void store(const Lanes &in, Get &&get) {
+  alignas(32) float lanes[10][VelocityIntegrator::lanes];
+
+  for (size_t i = 0; i < 3; ++i) {
+    _mm256_store_ps(lanes[i], in.position[i]);
+    _mm256_store_ps(lanes[3 + i], in.scale[i]);
+  }
+  for (size_t i = 0; i < 4; ++i) {
+    _mm256_store_ps(lanes[6 + i], in.rotation[i]);
+  }
+  for (size_t lane = 0; lane < VelocityIntegrator::lanes; ++lane) {
+    Transform &transform = get(lane);
+
+    transform.position = glm::vec3(lanes[0][lane], lanes[1][lane], lanes[2][lane]);
+    transform.scale = glm::vec3(lanes[3][lane], lanes[4][lane], lanes[5][lane]);
+    transform.rotation = glm::quat(lanes[6][lane], lanes[7][lane], lanes[8][lane], lanes[9][lane]);
+  }
+}
+} // namespace
+
+void VelocityIntegrator::integrate_batch(size_t first, float delta) {
+  const Body *bodies = &_bodies[first];
+  auto transform = [bodies](size_t lane) -> Transform & { return *bodies[lane].transform; };
+  auto velocity = [bodies](size_t lane) -> Transform & { return *bodies[lane].velocity; };
+  __m256 decay = gather([bodies](size_t lane) { return bodies[lane].decay; });
+
+  /* growing velocities would need a slerp factor above 1 */
+  if (_mm256_movemask_ps(_mm256_cmp_ps(decay, set(0), _CMP_LT_OQ))) {
+    for (size_t lane = 0; lane < lanes; ++lane) {
+      integrate_one(transform(lane), velocity(lane), bodies[lane].decay, delta);
+    }
+    return;
+  }
+
+  Lanes tm;
+  Lanes vel;
+  load(tm, transform);
+  load(vel, velocity);
+  __m256 t = set(delta);
+
+  __m256 step[4];
+  __m256 rotation[4];
+  __m256 log_scale[3];
+  slerp(vel.rotation, t, step);
+  multiply(tm.rotation, step, rotation);
+  for (size_t i = 0; i < 4; ++i) {
+    tm.rotation[i] = rotation[i];
+  }
+  for (size_t i = 0; i < 3; ++i) {
+    tm.position[i] = add(tm.position[i], mul(vel.position[i], t));
+    log_scale[i] = log(vel.scale[i]);
+    tm.scale[i] = mul(tm.scale[i], pow(vel.scale[i], log_scale[i], t));
+  }
+  store(tm, transform);
+
+  /* (1 - decay)^delta, velocities without decay are left untouched */
+  __m256 decaying = _mm256_cmp_ps(decay, set(0), _CMP_NEQ_UQ);
+  if (!_mm256_movemask_ps(decaying)) {
+    return;
+  }
+  __m256 kept = sub(set(1), decay);
+  __m256 factor = pow(kept, log(kept), t);
+
+  slerp(vel.rotation, factor, rotation);
+  for (size_t i = 0; i < 4; ++i) {
+    vel.rotation[i] = _mm256_blendv_ps(vel.rotation[i], rotation[i], decaying);
+  }
+  for (size_t i = 0; i < 3; ++i) {
+    __m256 position = mul(vel.position[i], factor);
+    __m256 scale = pow(vel.scale[i], log_scale[i], factor);
+
+    vel.position[i] = _mm256_blendv_ps(vel.position[i], position, decaying);
+    vel.scale[i] = _mm256_blendv_ps(vel.scale[i], scale, decaying);
+  }
+  store(vel, velocity);
+}
+#else
+void VelocityIntegrator::integrate_batch(size_t first, float delta) {
+  for (size_t body = first; body < first + lanes; ++body) {
+    integrate_one(*_bodies[body].transform, *_bodies[body].velocity, _bodies[body].decay, delta);
+  }
+}
+#endif
@@ -0,0 +1,59 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Velocity integrator
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "TaskPool.hpp"
+#include "Transform.hpp"
+
+namespace cevy::engine {
+/**
+ * @brief Resource applying the TransformVelocity of every entity to its Transform
+ *
+ * TransformVelocity::system pushes every moving entity, then integrate() moves them all.
+ * With AVX, 8 entities are integrated at a time, one per lane: the slerp of the rotation
+ * and the pow of the scale and of the decay are computed with polynomial approximations,
+ * within about 1e-5 of the scalar glm path.
+ * Above parallel_threshold entities, the work is split over the TaskPool, if there is one.
+ */
+class VelocityIntegrator {
+  public:
+  static constexpr size_t lanes = 8;
+  /// Entities from which the TaskPool is used
+  static constexpr size_t parallel_threshold = 16384;
+  /// Entities per task, a multiple of lanes
+  static constexpr size_t grain = 4096;
+
+  void clear();
+
+  /// Add an entity, decay is PhysicsProps::decay, or 0 without PhysicsProps
+  void push(Transform &transform, Transform &velocity, float decay);
+
+  /// Move every pushed entity by delta seconds of its velocity, and decay the velocities
+  void integrate(float delta, ecs::TaskPool *pool = nullptr);
+
+  size_t size() const { return _bodies.size(); }
+
+  /// Scalar integration of one entity
+  static void integrate_one(Transform &transform, Transform &velocity, float decay, float delta);
+
+  protected:
+  struct Body {
+    Transform *transform;
+    Transform *velocity;
+    float decay;
+  };
+
+  void integrate_range(size_t first, size_t last, float delta);
+  void integrate_batch(size_t first, float delta);
+
+  std::vector<Body> _bodies;
+};
+} // namespace cevy::engine
@@ -107,3 +107,7 @@ cevy::engine::AssetManager::get<cevy::engine::Model>(std::string name);
 template <>
 std::optional<cevy::engine::Handle<cevy::engine::Texture>>
 cevy::engine::AssetManager::get<cevy::engine::Texture>(std::string name);
+
+/// the last handle on a model frees its GL buffers, which is kept out of the command flush
+template <>
+struct cevy::ecs::deferred_drop<cevy::engine::Handle<cevy::engine::Model>> : std::true_type {};
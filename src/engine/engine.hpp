@@ -20,6 +20,20 @@ struct DebugWindow {
 };
 #endif
 
+/**
+ * @brief Resource enabling pipelined rendering
+ *
+ * At the RenderStage sync point, the render components of frame N are extracted into
+ * a separate render world, then drawn and swapped on a render thread while the main
+ * schedule moves on to frame N+1.
+ * '''
+ * app.init_resource<cevy::engine::PipelinedRendering>();
+ * '''
+ * @warning The gl context belongs to the render thread once the first frame is drawn:
+ * models and textures must be loaded during the startup stages.
+ */
+struct PipelinedRendering {};
+
 class StartupRenderStage : public cevy::ecs::core_stage::after<cevy::ecs::core_stage::PreStartup> {
 };
 class PreStartupRenderStage : public cevy::ecs::core_stage::before<StartupRenderStage> {};
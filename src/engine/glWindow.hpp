@@ -7,20 +7,31 @@
 
 #pragma once
 
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
 #include <optional>
 #include <stdexcept>
+#include <thread>
+#include <utility>
 
 #include "App.hpp"
+#include "Atmosphere.hpp"
 #include "Camera.hpp"
 #include "Color.hpp"
 #include "Event.hpp"
+#include "GlobalTransform.hpp"
 #include "Handle.hpp"
 #include "Model.hpp"
 #include "PbrMaterial.hpp"
 #include "Plugin.hpp"
+#include "PointLight.hpp"
 #include "Query.hpp"
 #include "Scheduler.hpp"
+#include "Transform.hpp"
 #include "Window.hpp"
+#include "engine.hpp"
 #include "glx.hpp"
 #include "pipeline.hpp"
 #include "state.hpp"
@@ -39,6 +50,7 @@ class glWindow : public cevy::engine::Window::generic_window {
 
   using Camera = cevy::engine::Camera;
   using Transform = cevy::engine::Transform;
+  using GlobalTransform = cevy::engine::GlobalTransform;
   using PbrMaterial = cevy::engine::PbrMaterial;
   using Color = cevy::engine::Color;
   using Model = cevy::engine::Model;
@@ -48,7 +60,8 @@ class glWindow : public cevy::engine::Window::generic_window {
   class Plugin : public cevy::ecs::Plugin {
     public:
     void build(cevy::ecs::App &app) override {
-      app.add_systems<cevy::ecs::core_stage::Startup>(glWindow<Renderer>::init_system);
+      app.add_systems<cevy::ecs::core_stage::Startup>(glWindow<Renderer>::init_system)
+          .main_thread();
       app.add_systems<cevy::engine::RenderStage>(glWindow<Renderer>::render_system);
     }
   };
@@ -70,6 +83,7 @@ class glWindow : public cevy::engine::Window::generic_window {
   glWindow(const glWindow &) = delete;
 
   ~glWindow() {
+    this->stop_render_thread();
     this->renderer.reset();
 
     if (this->glfWindow) {
@@ -116,7 +130,13 @@ class glWindow : public cevy::engine::Window::generic_window {
 
   static void render_system(Resource<cevy::engine::Window> win,
                             EventWriter<cevy::ecs::AppExit> close, cevy::ecs::World &world) {
-    win.get().get_handler<glWindow, Renderer>()->render(close, world);
+    auto self = win.get().get_handler<glWindow, Renderer>();
+
+    if (world.contains_resource<cevy::engine::PipelinedRendering>()) {
+      self->render_pipelined(close, world);
+    } else {
+      self->render(close, world);
+    }
   }
 
   void render(EventWriter<cevy::ecs::AppExit> close, cevy::ecs::World &world) {
@@ -129,18 +149,97 @@ class glWindow : public cevy::engine::Window::generic_window {
 
     glfwSwapBuffers(this->glfWindow);
 
-    this->keyboardInputWriter->clear();
-    this->mouseInputWriter->clear();
-    this->cursorMovedWriter->clear();
-    this->windowFocusedWriter->clear();
-    this->cursorEnteredWriter->clear();
-    this->cursorLeftWriter->clear();
+    this->poll();
+  }
+
+  /**
+   * @brief Hand the frame over to the render thread and return to the simulation
+   *
+   * Waits for the previous frame to be drawn, copies the render components into the
+   * render world, then lets the render thread draw and swap while the next frame is updated.
+   * Window events are still polled here, on the main thread.
+   */
+  void render_pipelined(EventWriter<cevy::ecs::AppExit> close, cevy::ecs::World &world) {
+    if (glfwWindowShouldClose(this->glfWindow)) {
+      close.send(cevy::ecs::AppExit());
+      return;
+    }
+    if (!this->render_thread.joinable()) {
+      this->start_render_thread();
+    }
 
-    glfwPollEvents();
+    std::unique_lock lock(this->render_mutex);
+    this->render_cv.wait(lock, [this] { return !this->frame_pending; });
+    if (this->render_error) {
+      std::rethrow_exception(std::exchange(this->render_error, nullptr));
+    }
+    extract(this->render_world, world);
+    this->frame_pending = true;
+    lock.unlock();
+    this->render_cv.notify_all();
+
+    this->poll();
   }
 
+  /// the events of the previous poll are dropped by the event update of First
+  void poll() { glfwPollEvents(); }
+
   void pollEvents() { glfwPollEvents(); }
 
+  /// Register the components read by the renderer in render_world, before any extract
+  static void init_render_world(cevy::ecs::World &render_world) {
+    render_world.init_component<Camera>();
+    render_world.init_component<Transform>();
+    render_world.init_component<GlobalTransform>();
+    render_world.init_component<Handle<Model>>();
+    render_world.init_component<Handle<PbrMaterial>>();
+    render_world.init_component<Color>();
+    render_world.init_component<cevy::engine::PointLight>();
+  }
+
+  /**
+   * @brief Copy everything the renderer reads from world into render_world
+   *
+   * Only the entities with a Camera, a PointLight or a model are extracted, packed into the
+   * first slots of render_world: render_world.entities()[slot] is the entity of world it was
+   * extracted from. Entities with a higher id than the last rendered one are not visited.
+   * Transforms are copied with their world position, and GlobalTransforms with them,
+   * parents do not need to be extracted.
+   */
+  static void extract(cevy::ecs::World &render_world, cevy::ecs::World &world) {
+    auto &entities = world.entities();
+    auto &cameras = world.get_components<Camera>();
+    auto &lights = world.get_components<cevy::engine::PointLight>();
+    auto &models = world.get_components<Handle<Model>>();
+    auto &extracted = render_world.entities();
+    size_t end = std::min(entities.size(),
+                          std::max({cameras.size(), lights.size(), models.size()}));
+
+    extracted.resize(0);
+    for (size_t id = 0; id < end; ++id) {
+      bool rendered = (id < cameras.size() && cameras[id]) ||
+                      (id < lights.size() && lights[id]) || (id < models.size() && models[id]);
+
+      if (entities[id] && rendered) {
+        extracted.insert_at(extracted.size(), *entities[id]);
+      }
+    }
+    extract_components<Camera>(render_world, world);
+    extract_components<Transform>(render_world, world);
+    extract_components<GlobalTransform>(render_world, world);
+    extract_components<Handle<Model>>(render_world, world);
+    extract_components<Handle<PbrMaterial>>(render_world, world);
+    extract_components<Color>(render_world, world);
+    extract_components<cevy::engine::PointLight>(render_world, world);
+
+    auto atmosphere = world.get_resource<cevy::engine::Atmosphere>();
+    if (atmosphere) {
+      render_world.insert_resource(atmosphere.value().get());
+    } else {
+      render_world.remove_resource<cevy::engine::Atmosphere>();
+    }
+  }
+
   std::optional<EventWriter<cevy::input::keyboardInput>> keyboardInputWriter;
   std::optional<EventWriter<cevy::input::mouseInput>> mouseInputWriter;
 
@@ -294,9 +393,82 @@ class glWindow : public cevy::engine::Window::generic_window {
     return static_cast<glWindow *>(glfwGetWindowUserPointer(glfWindow));
   }
 
+  template <typename T>
+  static void extract_components(cevy::ecs::World &render_world, cevy::ecs::World &world) {
+    auto &extracted = render_world.entities();
+    auto &from = world.get_components<T>();
+    auto &to = render_world.get_components<T>();
+
+    to.resize(0);
+    for (size_t slot = 0; slot < extracted.size(); ++slot) {
+      size_t id = *extracted[slot];
+
+      if (id < from.size() && from[id]) {
+        to.insert_at(slot, *from[id]);
+      }
+    }
+  }
+
+  /// The gl context is moved to the render thread, it is given back when the thread stops
+  void start_render_thread() {
+    init_render_world(this->render_world);
+
+    glfwMakeContextCurrent(nullptr);
+    this->render_thread = std::thread([this] { this->render_loop(); });
+  }
+
+  void stop_render_thread() {
+    if (!this->render_thread.joinable()) {
+      return;
+    }
+    {
+      std::lock_guard lock(this->render_mutex);
+      this->render_stop = true;
+    }
+    this->render_cv.notify_all();
+    this->render_thread.join();
+    glfwMakeContextCurrent(this->glfWindow);
+  }
+
+  void render_loop() {
+    glfwMakeContextCurrent(this->glfWindow);
+    while (true) {
+      std::unique_lock lock(this->render_mutex);
+      this->render_cv.wait(lock, [this] { return this->frame_pending || this->render_stop; });
+      if (!this->frame_pending) {
+        break;
+      }
+      lock.unlock();
+
+      try {
+        this->render_world.run_system_with(Renderer::render_system, *this->renderer);
+        glfwSwapBuffers(this->glfWindow);
+      } catch (...) {
+        lock.lock();
+        this->render_error = std::current_exception();
+        lock.unlock();
+      }
+
+      lock.lock();
+      this->frame_pending = false;
+      lock.unlock();
+      this->render_cv.notify_all();
+    }
+    glfwMakeContextCurrent(nullptr);
+  }
+
   int width;
   int height;
   GLFWwindow *glfWindow;
   PbrMaterial defaultMaterial;
   std::unique_ptr<Renderer> renderer;
+
+  /* pipelined rendering, only used with the PipelinedRendering resource */
+  cevy::ecs::World render_world;
+  std::thread render_thread;
+  std::mutex render_mutex;
+  std::condition_variable render_cv;
+  bool frame_pending = false;
+  bool render_stop = false;
+  std::exception_ptr render_error = nullptr;
 };
@@ -54,8 +54,8 @@ void update_mouse_motion_window_focus(
     cursorPosition->delta = delta;
   }
 
-  auto left = cursorLeftReader.raw_data.event_queue.size();
-  auto entered = cursorEnteredReader.raw_data.event_queue.size();
+  auto left = cursorLeftReader.size();
+  auto entered = cursorEnteredReader.size();
 
   cursorInWindow->inside = bool((cursorInWindow->inside + left + entered) % 2);
 }
@@ -0,0 +1,65 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Axis aligned bounding box
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#include "Vector.hpp"
+
+namespace cevy::engine {
+/// Axis aligned bounding box, from its min corner to its max corner
+struct AABB {
+  Vector min;
+  Vector max;
+
+  AABB() = default;
+  AABB(const Vector &min, const Vector &max) : min(min), max(max) {}
+
+  /// Whether both boxes overlap, touching boxes do
+  bool intersects(const AABB &rhs) const {
+    return min.x <= rhs.max.x && rhs.min.x <= max.x && min.y <= rhs.max.y &&
+           rhs.min.y <= max.y && min.z <= rhs.max.z && rhs.min.z <= max.z;
+  }
+
+  /// Whether rhs is inside this box
+  bool contains(const AABB &rhs) const {
+    return min.x <= rhs.min.x && min.y <= rhs.min.y && min.z <= rhs.min.z &&
+           rhs.max.x <= max.x && rhs.max.y <= max.y && rhs.max.z <= max.z;
+  }
+
+  /**
+   * @brief Whether a ray hits the box before max_distance, slab test
+   *
+   * inverse_direction is 1 / direction, per component. distance is set to the distance
+   * along the ray where it enters the box, 0 when it starts inside.
+   */
+  bool raycast(const Vector &origin, const Vector &inverse_direction, float max_distance,
+               float &distance) const {
+    float enter = 0;
+    float leave = max_distance;
+
+    for (size_t axis = 0; axis < 3; ++axis) {
+      float start = (&origin.x)[axis];
+      float inverse = (&inverse_direction.x)[axis];
+      float t1 = ((&min.x)[axis] - start) * inverse;
+      float t2 = ((&max.x)[axis] - start) * inverse;
+
+      enter = std::max(enter, std::min(t1, t2));
+      leave = std::min(leave, std::max(t1, t2));
+    }
+    distance = enter;
+    return enter <= leave;
+  }
+
+  bool operator==(const AABB &rhs) const { return min == rhs.min && max == rhs.max; }
+
+  /// Smallest box containing both boxes
+  AABB merge(const AABB &rhs) const { return AABB(min.min(rhs.min), max.max(rhs.max)); }
+};
+} // namespace cevy::engine
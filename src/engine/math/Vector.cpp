@@ -5,7 +5,6 @@
 ** Vector
 */
 
-/*
 #include "Vector.hpp"
 #include <algorithm>
 #include <cmath>
@@ -14,76 +13,90 @@
 
 using namespace cevy::engine;
 
-#if 0 && (defined(__i386__) || defined(__x86_64__))
+#ifdef __SSE2__
 #include <immintrin.h>
 
+/// x y z of v, w cleared
+static inline __m128 load_xyz(const Vector &v) {
+  return _mm_and_ps(_mm_load_ps(&v.x), _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)));
+}
+
+/// sum of the 4 floats of v, in every float
+static inline __m128 sum(__m128 v) {
+  v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+static inline Vector store(__m128 v) {
+  Vector ret;
+
+  _mm_store_ps(&ret.x, v);
+  return ret;
+}
 
 float Vector::eval() const {
-  __m128 v = _mm_load_ps(&x);
-  v = _mm_mul_ps(v, v);
-  v = _mm_hadd_ps(v, v);
-  v = _mm_hadd_ps(v, v);
-  return _mm_cvtss_f32(v);
+  __m128 v = load_xyz(*this);
+  return _mm_cvtss_f32(sum(_mm_mul_ps(v, v)));
 }
 
 Vector &Vector::operator+=(const Vector &rhs) {
-  __m128 xmm0 = _mm_load_ps(&x);
-  __m128 xmm1 = _mm_load_ps(&rhs.x);
-  xmm0 = _mm_add_ps(xmm0, xmm1);
-  _mm_store_ps(&x, xmm0);
+  _mm_store_ps(&x, _mm_add_ps(_mm_load_ps(&x), _mm_load_ps(&rhs.x)));
   return *this;
 }
 
 Vector &Vector::operator-=(const Vector &rhs) {
-  __m128 xmm0 = _mm_load_ps(&x);
-  __m128 xmm1 = _mm_load_ps(&rhs.x);
-  xmm0 = _mm_sub_ps(xmm0, xmm1);
-  _mm_store_ps(&x, xmm0);
+  _mm_store_ps(&x, _mm_sub_ps(_mm_load_ps(&x), _mm_load_ps(&rhs.x)));
   return *this;
 }
 
 Vector &Vector::operator*=(float k) {
-  __m128 k_v = _mm_set1_ps(k);
-  __m128 this_v = _mm_load_ps(&x);
-  this_v = _mm_mul_ps(this_v, k_v);
-  _mm_store_ps(&x, this_v);
+  _mm_store_ps(&x, _mm_mul_ps(_mm_load_ps(&x), _mm_set1_ps(k)));
   return *this;
 }
 
 Vector &Vector::operator/=(float k) {
-  __m128 k_v = _mm_set1_ps(1 / k);
-  __m128 this_v = _mm_load_ps(&x);
-  this_v = _mm_mul_ps(this_v, k_v);
-  _mm_store_ps(&x, this_v);
+  _mm_store_ps(&x, _mm_div_ps(_mm_load_ps(&x), _mm_set1_ps(k)));
   return *this;
 }
 
 float Vector::operator*(const Vector &rhs) const {
-  __m128 xmm0 = _mm_load_ps(&x);
-  __m128 xmm1 = _mm_load_ps(&rhs.x);
-  xmm0 = _mm_mul_ps(xmm0, xmm1);
-  xmm0 = _mm_hadd_ps(xmm0, xmm0);
-  xmm0 = _mm_hadd_ps(xmm0, xmm0);
-  return _mm_cvtss_f32(xmm0);
+  return _mm_cvtss_f32(sum(_mm_mul_ps(load_xyz(*this), load_xyz(rhs))));
 }
 
 Vector Vector::scale(const Vector &rhs) const {
-  Vector v;
-  __m128 xmm0 = _mm_load_ps(&x);
-  __m128 xmm1 = _mm_load_ps(&rhs.x);
-  xmm0 = _mm_mul_ps(xmm0, xmm1);
-  _mm_store_ps(&v.x, xmm0);
-  return v;
+  return store(_mm_mul_ps(_mm_load_ps(&x), _mm_load_ps(&rhs.x)));
 }
 
-#else
+Vector Vector::operator/(const Vector &rhs) const {
+  /* w / w would be 0 / 0 */
+  __m128 divisor = _mm_or_ps(load_xyz(rhs), _mm_set_ps(1, 0, 0, 0));
+  return store(_mm_div_ps(load_xyz(*this), divisor));
+}
 
-std::ostream &cevy::engine::operator<<(std::ostream &cout, const Vector &vec) {
-  cout << "{ " << vec.x << ", " << vec.y << ", " << vec.z << " }";
+Vector Vector::min(const Vector &rhs) const {
+  return store(_mm_min_ps(_mm_load_ps(&x), _mm_load_ps(&rhs.x)));
+}
 
-  return cout;
+Vector Vector::max(const Vector &rhs) const {
+  return store(_mm_max_ps(_mm_load_ps(&x), _mm_load_ps(&rhs.x)));
 }
 
+Vector Vector::cross(const Vector &rhs) const {
+  __m128 a = _mm_load_ps(&x);
+  __m128 b = _mm_load_ps(&rhs.x);
+  __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+  __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+  __m128 c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+
+  return store(_mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)));
+}
+
+bool Vector::operator==(const Vector &rhs) const {
+  return (_mm_movemask_ps(_mm_cmpeq_ps(_mm_load_ps(&x), _mm_load_ps(&rhs.x))) & 0b111) == 0b111;
+}
+
+#else
+
 float Vector::eval() const { return (x * x + y * y + z * z); }
 
 Vector &Vector::operator+=(const Vector &rhs) {
@@ -118,21 +131,49 @@ float Vector::operator*(const Vector &rhs) const { return x * rhs.x + y * rhs.y
 
 Vector Vector::scale(const Vector &rhs) const { return Vector(x * rhs.x, y * rhs.y, z * rhs.z); }
 
+Vector Vector::operator/(const Vector &rhs) const {
+  Vector v = Vector(x / rhs.x, y / rhs.y, z / rhs.z);
+  return v;
+}
+
+Vector Vector::min(const Vector &rhs) const {
+  return Vector(std::min(x, rhs.x), std::min(y, rhs.y), std::min(z, rhs.z));
+}
+
+Vector Vector::max(const Vector &rhs) const {
+  return Vector(std::max(x, rhs.x), std::max(y, rhs.y), std::max(z, rhs.z));
+}
+
+Vector Vector::cross(const Vector &rhs) const {
+  Vector p;
+  p.x = (y * rhs.z) - (z * rhs.y);
+  p.y = -((x * rhs.z) - (z * rhs.x));
+  p.z = (x * rhs.y) - (y * rhs.x);
+  return p;
+}
+
+bool Vector::operator==(const Vector &rhs) const { return x == rhs.x && y == rhs.y && z == rhs.z; }
+
 #endif
 
-Vector::Vector() : x(0), y(0), z(0){};
+std::ostream &cevy::engine::operator<<(std::ostream &cout, const Vector &vec) {
+  cout << "{ " << vec.x << ", " << vec.y << ", " << vec.z << " }";
+
+  return cout;
+}
 
-Vector::Vector(float x, float y, float z) : x(x), y(y), z(z){};
+Vector::Vector() : x(0), y(0), z(0) {};
+
+Vector::Vector(float x, float y, float z) : x(x), y(y), z(z) {};
 
 Vector &Vector::operator=(const Vector &rhs) {
   x = rhs.x;
   y = rhs.y;
   z = rhs.z;
+  w = rhs.w;
   return *this;
 }
 
-bool Vector::operator==(const Vector &rhs) const { return x == rhs.x && y == rhs.y && z == rhs.z; }
-
 #if __cplusplus >= 202300
 auto Vector::operator<=>(const Vector &rhs) const { return eval() - rhs.eval(); }
 #endif
@@ -177,21 +218,8 @@ Vector Vector::operator/(float k) const {
   return v;
 }
 
-Vector Vector::operator/(const Vector &rhs) const {
-  Vector v = Vector(x / rhs.x, y / rhs.y, z / rhs.z);
-  return v;
-}
-
-Vector Vector::cross(const Vector &rhs) const {
-  Vector p;
-  p.x = (y * rhs.z) - (z * rhs.y);
-  p.y = -((x * rhs.z) - (z * rhs.x));
-  p.z = (x * rhs.y) - (y * rhs.x);
-  return p;
-}
-
-void Vector::rotate(const Quaternion &rot) {
-  Vector3 rotated = Vector3RotateByQuaternion(*this, rot);
+void Vector::rotate(const glm::quat &rot) {
+  glm::vec3 rotated = rot * glm::vec3(*this);
   this->x = rotated.x;
   this->y = rotated.y;
   this->z = rotated.z;
@@ -258,5 +286,3 @@ Vector Vector::random(float degree, const Vector &source) {
 }
 
 #endif
-
-*/
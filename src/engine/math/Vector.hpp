@@ -7,15 +7,24 @@
 
 #pragma once
 
-// #include "network.hpp"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <ostream>
 
+#if __has_include("network.hpp")
+#include "network.hpp"
+#endif
+
 namespace cevy::engine {
 /**
  * Vector for 3D math
  * implements basic operands, as well as dot product with '*'
+ *
+ * The 4 floats are loaded in a single SSE register, w is kept at 0 and ignored
+ * by the dot product, length and comparisons.
+ * See VectorBatch.hpp for kernels over arrays of Vector.
  */
-class Vector {
+class alignas(16) Vector {
   public:
   struct __attribute__((aligned(16))) {
     float x;
@@ -30,8 +39,8 @@ class Vector {
   Vector(float x, float y, float z);
   Vector(const Vector &) = default;
 
-  Vector(const Vector3 &v) : x(v.x), y(v.y), z(v.z) {};
-  operator Vector3() const { return ((Vector3) {(float)x, (float)y, (float)z}); }
+  Vector(const glm::vec3 &v) : x(v.x), y(v.y), z(v.z) {};
+  operator glm::vec3() const { return glm::vec3(x, y, z); }
 
   Vector &operator=(const Vector &);
 
@@ -86,6 +95,12 @@ class Vector {
    */
   Vector clamp(float min, float max) const;
 
+  /**
+   * Per component minimum and maximum
+   */
+  Vector min(const Vector &rhs) const;
+  Vector max(const Vector &rhs) const;
+
   /**
    * Scalar product
    */
@@ -107,7 +122,7 @@ class Vector {
   Vector cross(const Vector &rhs) const;
 
   void rotate(const Vector &rot);
-  void rotate(const Quaternion &rot);
+  void rotate(const glm::quat &rot);
   void rotateR(const Vector &rot);
 
   Vector reflect(const Vector &normal) const;
@@ -122,9 +137,10 @@ std::ostream &operator<<(std::ostream &cout, const Vector &vec);
 
 } // namespace cevy::engine
 
+#if __has_include("network.hpp")
 template <>
 struct cevy::serialized_size<cevy::engine::Vector>
-    : public std::integral_constant<size_t, 4 * serialized_size<float>::value> {};
+    : public std::integral_constant<size_t, 3 * serialized_size<float>::value> {};
 
 template <>
 inline std::vector<uint8_t> &cevy::serialize<cevy::engine::Vector>(std::vector<uint8_t> &vec,
@@ -134,3 +150,4 @@ inline std::vector<uint8_t> &cevy::serialize<cevy::engine::Vector>(std::vector<u
   serialize(vec, t.z);
   return vec;
 }
+#endif
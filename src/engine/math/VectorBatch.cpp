@@ -0,0 +1,192 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Kernels over arrays of Vector
+*/
+
+#include "VectorBatch.hpp"
+
+#include <cmath>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+using cevy::engine::AABB;
+using cevy::engine::Vector;
+
+static_assert(sizeof(Vector) == 4 * sizeof(float), "Vector must be exactly x y z w");
+static_assert(sizeof(AABB) == 2 * sizeof(Vector), "AABB must be exactly min max");
+
+#ifdef __AVX__
+/* two Vector per register, one per 128 bit half */
+static inline __m256 load(const Vector *v) { return _mm256_loadu_ps(&v->x); }
+static inline void store(Vector *v, __m256 value) { _mm256_storeu_ps(&v->x, value); }
+
+static inline __m256 xyz(__m256 v) {
+  return _mm256_and_ps(v, _mm256_castsi256_ps(_mm256_set_epi32(0, -1, -1, -1, 0, -1, -1, -1)));
+}
+
+/// a[i] * b[i] of 8 Vector, in order
+static inline __m256 dot8(const Vector *a, const Vector *b) {
+  __m256 p[4];
+
+  for (size_t i = 0; i < 4; ++i) {
+    p[i] = _mm256_mul_ps(xyz(load(a + 2 * i)), load(b + 2 * i));
+  }
+  /* dots 0 2 4 6 in the low half, 1 3 5 7 in the high half */
+  __m256 dots = _mm256_hadd_ps(_mm256_hadd_ps(p[0], p[1]), _mm256_hadd_ps(p[2], p[3]));
+  __m128 even = _mm256_castps256_ps128(dots);
+  __m128 odd = _mm256_extractf128_ps(dots, 1);
+  return _mm256_set_m128(_mm_unpackhi_ps(even, odd), _mm_unpacklo_ps(even, odd));
+}
+
+static inline __m256 yzx(__m256 v) { return _mm256_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 2, 1)); }
+#endif
+
+void cevy::engine::batch::dot(const Vector *a, const Vector *b, float *out, size_t count) {
+  size_t i = 0;
+
+#ifdef __AVX__
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(out + i, dot8(a + i, b + i));
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] = a[i] * b[i];
+  }
+}
+
+void cevy::engine::batch::cross(const Vector *a, const Vector *b, Vector *out, size_t count) {
+  size_t i = 0;
+
+#ifdef __AVX__
+  for (; i + 2 <= count; i += 2) {
+    __m256 va = load(a + i);
+    __m256 vb = load(b + i);
+    __m256 c = _mm256_sub_ps(_mm256_mul_ps(va, yzx(vb)), _mm256_mul_ps(yzx(va), vb));
+
+    store(out + i, yzx(c));
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] = a[i].cross(b[i]);
+  }
+}
+
+void cevy::engine::batch::length(const Vector *v, float *out, size_t count) {
+  size_t i = 0;
+
+#ifdef __AVX__
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(out + i, _mm256_sqrt_ps(dot8(v + i, v + i)));
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] = v[i].magnitude();
+  }
+}
+
+void cevy::engine::batch::normalize(const Vector *v, Vector *out, size_t count) {
+  size_t i = 0;
+
+#ifdef __AVX__
+  for (; i + 2 <= count; i += 2) {
+    __m256 value = load(v + i);
+    /* squared length of each Vector, in its 4 floats */
+    __m256 squared = _mm256_dp_ps(value, value, 0x7f);
+    __m256 large = _mm256_cmp_ps(squared, _mm256_set1_ps(0.0001f), _CMP_NLT_UQ);
+    __m256 unit = _mm256_div_ps(value, _mm256_sqrt_ps(squared));
+
+    store(out + i, _mm256_blendv_ps(value, unit, large));
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] = v[i].normalize();
+  }
+}
+
+void cevy::engine::batch::min(const Vector *a, const Vector *b, Vector *out, size_t count) {
+  size_t i = 0;
+
+#ifdef __AVX__
+  for (; i + 2 <= count; i += 2) {
+    store(out + i, _mm256_min_ps(load(a + i), load(b + i)));
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] = a[i].min(b[i]);
+  }
+}
+
+void cevy::engine::batch::max(const Vector *a, const Vector *b, Vector *out, size_t count) {
+  size_t i = 0;
+
+#ifdef __AVX__
+  for (; i + 2 <= count; i += 2) {
+    store(out + i, _mm256_max_ps(load(a + i), load(b + i)));
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] = a[i].max(b[i]);
+  }
+}
+
+AABB cevy::engine::batch::bounds(const Vector *points, size_t count) {
+  if (count == 0) {
+    return AABB();
+  }
+  AABB box(points[0], points[0]);
+  size_t i = 1;
+
+#ifdef __AVX__
+  if (count >= 3) {
+    __m256 low = load(points + 1);
+    __m256 high = low;
+
+    for (i = 3; i + 2 <= count; i += 2) {
+      __m256 pair = load(points + i);
+
+      low = _mm256_min_ps(low, pair);
+      high = _mm256_max_ps(high, pair);
+    }
+    Vector halves[2];
+    store(halves, low);
+    box.min = box.min.min(halves[0]).min(halves[1]);
+    store(halves, high);
+    box.max = box.max.max(halves[0]).max(halves[1]);
+  }
+#endif
+  for (; i < count; ++i) {
+    box.min = box.min.min(points[i]);
+    box.max = box.max.max(points[i]);
+  }
+  return box;
+}
+
+AABB cevy::engine::batch::merge(const AABB *boxes, size_t count) {
+  if (count == 0) {
+    return AABB();
+  }
+  AABB box = boxes[0];
+  size_t i = 1;
+
+#ifdef __AVX__
+  /* min in the low half, max in the high half */
+  __m256 low = _mm256_loadu_ps(&box.min.x);
+  __m256 high = low;
+
+  for (; i < count; ++i) {
+    __m256 next = _mm256_loadu_ps(&boxes[i].min.x);
+
+    low = _mm256_min_ps(low, next);
+    high = _mm256_max_ps(high, next);
+  }
+  _mm256_storeu_ps(&box.min.x, _mm256_blend_ps(low, high, 0xf0));
+#endif
+  for (; i < count; ++i) {
+    box = box.merge(boxes[i]);
+  }
+  return box;
+}
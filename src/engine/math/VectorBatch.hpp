@@ -0,0 +1,51 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Kernels over arrays of Vector
+*/
+
+#pragma once
+
+#include <cstddef>
+
+#include "AABB.hpp"
+#include "Vector.hpp"
+
+/**
+ * @brief Vector operations over arrays, for broadphase and narrowphase loops
+ *
+ * Each kernel gives the same results as the Vector method it is named after, over count
+ * elements. With AVX, two Vector are processed per register, and dot and length 8 at a time.
+ * Outputs may alias the inputs.
+ * '''
+ * std::vector<Vector> velocities = ...;
+ * std::vector<float> speeds(velocities.size());
+ * batch::length(velocities.data(), speeds.data(), velocities.size());
+ * '''
+ */
+namespace cevy::engine::batch {
+/// out[i] = a[i] * b[i]
+void dot(const Vector *a, const Vector *b, float *out, size_t count);
+
+/// out[i] = a[i].cross(b[i])
+void cross(const Vector *a, const Vector *b, Vector *out, size_t count);
+
+/// out[i] = v[i].magnitude()
+void length(const Vector *v, float *out, size_t count);
+
+/// out[i] = v[i].normalize()
+void normalize(const Vector *v, Vector *out, size_t count);
+
+/// out[i] = a[i].min(b[i])
+void min(const Vector *a, const Vector *b, Vector *out, size_t count);
+
+/// out[i] = a[i].max(b[i])
+void max(const Vector *a, const Vector *b, Vector *out, size_t count);
+
+/// Smallest box containing every point, an empty box at 0 without points
+AABB bounds(const Vector *points, size_t count);
+
+/// Smallest box containing every box, an empty box at 0 without boxes
+AABB merge(const AABB *boxes, size_t count);
+} // namespace cevy::engine::batch
@@ -134,8 +134,11 @@ void cevy::engine::DeferredRenderer::init() {
 
 void cevy::engine::DeferredRenderer::render_system(
     DeferredRenderer &self, Query<Camera> cams,
-    Query<option<Transform>, Handle<Model>, option<Handle<PbrMaterial>>, option<Color>> models,
-    Query<option<Transform>, cevy::engine::PointLight> lights, const ecs::World &world) {
+    Query<option<Transform>, option<GlobalTransform>, Handle<Model>, option<Handle<PbrMaterial>>,
+          option<Color>>
+        models,
+    Query<option<Transform>, option<GlobalTransform>, cevy::engine::PointLight> lights,
+    const ecs::World &world) {
 
   auto r_atmo = world.get_resource<const Atmosphere>();
   const auto &atmosphere = r_atmo.has_value() ? r_atmo->get() : cevy::engine::Atmosphere();
@@ -172,8 +175,15 @@ void cevy::engine::DeferredRenderer::render_system(
   glUniformMatrix4fv(self.gBuffer_shader->uniform("view"), 1, GL_FALSE, glm::value_ptr(view));
   glUniformMatrix4fv(self.gBuffer_shader->uniform("invView"), 1, GL_FALSE, glm::value_ptr(invView));
 
-  for (auto [o_tm, model, o_material, o_color] : models) {
-    auto tm = o_tm ? o_tm->get_world().mat4() : glm::mat4(1);
+  self.drawMatrices.clear();
+  for (auto [o_tm, o_global, model, o_material, o_color] : models) {
+    self.drawMatrices.push(world_matrix(o_tm, o_global), model->modelMatrix(),
+                           model->tNormalMatrix());
+  }
+  self.drawMatrices.compute();
+
+  size_t draw = 0;
+  for (auto [o_tm, o_global, model, o_material, o_color] : models) {
     glm::vec4 white = glm::vec4(1, 1, 1, 1);
     auto &color = o_color ? o_color.value().as_vec() : white;
     PbrMaterial &material = o_material ? o_material->get() : self.defaultMaterial;
@@ -188,9 +198,10 @@ void cevy::engine::DeferredRenderer::render_system(
     glUniform1f(self.gBuffer_shader->uniform("roughness_const"), 1 / material.phong_exponent);
     glUniform1i(self.gBuffer_shader->uniform("halflambert"), material.halflambert);
     glUniformMatrix4fv(self.gBuffer_shader->uniform("model"), 1, GL_FALSE,
-                       glm::value_ptr(tm * model->modelMatrix()));
+                       glm::value_ptr(self.drawMatrices.model(draw)));
     glUniformMatrix3fv(self.gBuffer_shader->uniform("model_normal"), 1, GL_TRUE,
-                       glm::value_ptr(model->tNormalMatrix() * glm::inverse(glm::mat3(tm))));
+                       glm::value_ptr(self.drawMatrices.normal(draw)));
+    draw += 1;
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, material.diffuse_texture.has_value()
@@ -218,8 +229,8 @@ void cevy::engine::DeferredRenderer::render_system(
 
   glClearStencil(0);
 
-  for (auto [o_tm, light] : lights) {
-    const auto &pos = o_tm.has_value() ? o_tm->get_world().position : glm::vec3();
+  for (auto [o_tm, o_global, light] : lights) {
+    const auto &pos = world_position(o_tm, o_global);
     pipeline::Light gl_light(light, pos);
 
 #if 0  // use stencil
@@ -9,6 +9,8 @@
 
 #include "Camera.hpp"
 #include "Color.hpp"
+#include "DrawMatrices.hpp"
+#include "GlobalTransform.hpp"
 #include "Handle.hpp"
 #include "Model.hpp"
 #include "PbrMaterial.hpp"
@@ -103,8 +105,11 @@ class cevy::engine::DeferredRenderer {
   void init();
   static void render_system(
       DeferredRenderer &self, Query<Camera> cams,
-      Query<option<Transform>, Handle<Model>, option<Handle<PbrMaterial>>, option<Color>> models,
-      Query<option<Transform>, cevy::engine::PointLight> lights, const ecs::World &world);
+      Query<option<Transform>, option<GlobalTransform>, Handle<Model>, option<Handle<PbrMaterial>>,
+            option<Color>>
+          models,
+      Query<option<Transform>, option<GlobalTransform>, cevy::engine::PointLight> lights,
+      const ecs::World &world);
 
   protected:
   GLFWwindow *glfWindow;
@@ -114,6 +119,8 @@ class cevy::engine::DeferredRenderer {
   std::unique_ptr<ShaderProgram> accumulate_shader = nullptr;
   std::unique_ptr<ShaderProgram> compose_shader = nullptr;
   PbrMaterial defaultMaterial;
+  /// matrices of the draws of the frame
+  DrawMatrices drawMatrices;
 
   std::string alive = "DeferredRenderer is uninitialized";
 
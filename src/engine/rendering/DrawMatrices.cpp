@@ -0,0 +1,139 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Per-draw matrices
+*/
+
+#include "DrawMatrices.hpp"
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+using cevy::engine::DrawMatrices;
+
+void DrawMatrices::clear() {
+  _world.clear();
+  _local.clear();
+  _local_normal.clear();
+}
+
+void DrawMatrices::push(const glm::mat4 &world, const glm::mat4 &model,
+                        const glm::mat3 &t_normal) {
+  _world.push_back(world);
+  _local.push_back(model);
+  _local_normal.push_back(t_normal);
+}
+
+void DrawMatrices::compute() {
+  size_t draw = 0;
+
+  _model.resize(size());
+  _normal.resize(size());
+#ifdef __AVX__
+  for (; draw + lanes <= size(); draw += lanes) {
+    compute_batch(draw);
+  }
+#endif
+  for (; draw < size(); ++draw) {
+    compute_one(draw);
+  }
+}
+
+void DrawMatrices::compute_one(size_t draw) {
+  _model[draw] = _world[draw] * _local[draw];
+  _normal[draw] = _local_normal[draw] * glm::inverse(glm::mat3(_world[draw]));
+}
+
+#ifdef __AVX__
+/* matrices are transposed to one register per element, m[col * rows + row], a draw per lane */
+template <size_t Cols, size_t Rows, typename Mat>
+static void load_lanes(__m256 *out, const std::vector<Mat> &mats, size_t first) {
+  alignas(32) float lanes[DrawMatrices::lanes];
+
+  for (size_t c = 0; c < Cols; ++c) {
+    for (size_t r = 0; r < Rows; ++r) {
+      for (size_t lane = 0; lane < DrawMatrices::lanes; ++lane) {
+        lanes[lane] = mats[first + lane][c][r];
+      }
+      out[c * Rows + r] = _mm256_load_ps(lanes);
+    }
+  }
+}
+
+template <size_t Cols, size_t Rows, typename Mat>
+static void store_lanes(const __m256 *in, std::vector<Mat> &mats, size_t first) {
+  alignas(32) float lanes[DrawMatrices::lanes];
+
+  for (size_t c = 0; c < Cols; ++c) {
+    for (size_t r = 0; r < Rows; ++r) {
+      _mm256_store_ps(lanes, in[c * Rows + r]);
+      for (size_t lane = 0; lane < DrawMatrices::lanes; ++lane) {
+        mats[first + lane][c][r] = lanes[lane];
+      }
+    }
+  }
+}
+
+/// out = a * b, column-major, N x N
+template <size_t N>
+static void multiply(__m256 *out, const __m256 *a, const __m256 *b) {
+  for (size_t c = 0; c < N; ++c) {
+    for (size_t r = 0; r < N; ++r) {
+      __m256 sum = _mm256_mul_ps(a[r], b[c * N]);
+
+      for (size_t k = 1; k < N; ++k) {
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(a[k * N + r], b[c * N + k]));
+      }
+      out[c * N + r] = sum;
+    }
+  }
+}
+
+void DrawMatrices::compute_batch(size_t first) {
+  __m256 world[16];
+  __m256 local[16];
+  __m256 model[16];
+
+  load_lanes<4, 4>(world, _world, first);
+  load_lanes<4, 4>(local, _local, first);
+  multiply<4>(model, world, local);
+  store_lanes<4, 4>(model, _model, first);
+
+  /* inverse of the upper 3x3 of world, by cofactors */
+  auto m = [&world](size_t c, size_t r) { return world[c * 4 + r]; };
+  auto cross = [](__m256 a, __m256 b, __m256 c, __m256 d) {
+    return _mm256_sub_ps(_mm256_mul_ps(a, b), _mm256_mul_ps(c, d));
+  };
+  __m256 inverse[9];
+  inverse[0] = cross(m(1, 1), m(2, 2), m(2, 1), m(1, 2));
+  inverse[3] = cross(m(2, 0), m(1, 2), m(1, 0), m(2, 2));
+  inverse[6] = cross(m(1, 0), m(2, 1), m(2, 0), m(1, 1));
+  inverse[1] = cross(m(2, 1), m(0, 2), m(0, 1), m(2, 2));
+  inverse[4] = cross(m(0, 0), m(2, 2), m(2, 0), m(0, 2));
+  inverse[7] = cross(m(2, 0), m(0, 1), m(0, 0), m(2, 1));
+  inverse[2] = cross(m(0, 1), m(1, 2), m(1, 1), m(0, 2));
+  inverse[5] = cross(m(1, 0), m(0, 2), m(0, 0), m(1, 2));
+  inverse[8] = cross(m(0, 0), m(1, 1), m(1, 0), m(0, 1));
+  __m256 det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m(0, 0), inverse[0]),
+                                           _mm256_mul_ps(m(0, 1), inverse[3])),
+                             _mm256_mul_ps(m(0, 2), inverse[6]));
+  __m256 one_over_det = _mm256_div_ps(_mm256_set1_ps(1), det);
+  for (auto &cofactor : inverse) {
+    cofactor = _mm256_mul_ps(cofactor, one_over_det);
+  }
+
+  __m256 local_normal[9];
+  __m256 normal[9];
+  load_lanes<3, 3>(local_normal, _local_normal, first);
+  multiply<3>(normal, local_normal, inverse);
+  store_lanes<3, 3>(normal, _normal, first);
+}
+#else
+void DrawMatrices::compute_batch(size_t first) {
+  for (size_t draw = first; draw < first + lanes; ++draw) {
+    compute_one(draw);
+  }
+}
+#endif
@@ -0,0 +1,60 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Per-draw matrices
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace cevy::engine {
+/**
+ * @brief Model and normal matrices of every draw of a frame
+ *
+ * The renderers push the world matrix and the matrices of the model of each draw,
+ * then compute() builds every model matrix and normal matrix at once.
+ * With AVX, they are computed 8 draws at a time, one draw per lane.
+ * '''
+ * matrices.clear();
+ * for (auto [o_tm, o_global, model, ...] : models)
+ *   matrices.push(world_matrix(o_tm, o_global), model->modelMatrix(), model->tNormalMatrix());
+ * matrices.compute();
+ * // draw i uses matrices.model(i) and matrices.normal(i)
+ * '''
+ */
+class DrawMatrices {
+  public:
+  static constexpr size_t lanes = 8;
+
+  void clear();
+
+  /// Add a draw, with the world matrix of the entity and the matrices of its model
+  void push(const glm::mat4 &world, const glm::mat4 &model, const glm::mat3 &t_normal);
+
+  /// Compute the matrices of every pushed draw
+  void compute();
+
+  size_t size() const { return _world.size(); }
+
+  /// world * model, of the draw
+  const glm::mat4 &model(size_t draw) const { return _model[draw]; }
+
+  /// Transposed normal matrix of the draw, t_normal * inverse(mat3(world))
+  const glm::mat3 &normal(size_t draw) const { return _normal[draw]; }
+
+  protected:
+  void compute_one(size_t draw);
+  void compute_batch(size_t first);
+
+  std::vector<glm::mat4> _world;
+  std::vector<glm::mat4> _local;
+  std::vector<glm::mat3> _local_normal;
+
+  std::vector<glm::mat4> _model;
+  std::vector<glm::mat3> _normal;
+};
+} // namespace cevy::engine
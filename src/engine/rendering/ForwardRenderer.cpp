@@ -71,8 +71,11 @@ void cevy::engine::ForwardRenderer::init() {
 
 void cevy::engine::ForwardRenderer::render_system(
     ForwardRenderer &self, Query<Camera> cams,
-    Query<option<Transform>, Handle<Model>, option<Handle<PbrMaterial>>, option<Color>> models,
-    Query<option<Transform>, cevy::engine::PointLight> lights, const ecs::World &world) {
+    Query<option<Transform>, option<GlobalTransform>, Handle<Model>, option<Handle<PbrMaterial>>,
+          option<Color>>
+        models,
+    Query<option<Transform>, option<GlobalTransform>, cevy::engine::PointLight> lights,
+    const ecs::World &world) {
 
   auto r_atmo = world.get_resource<const Atmosphere>();
   const auto &atmosphere = r_atmo.has_value() ? r_atmo->get() : cevy::engine::Atmosphere();
@@ -101,13 +104,12 @@ void cevy::engine::ForwardRenderer::render_system(
   light_buffer.clear();
   light_buffer.reserve(pipeline::Light::count);
 
-  for (auto [o_tm, light] : lights) {
+  for (auto [o_tm, o_global, light] : lights) {
     if (light_buffer.size() >= pipeline::Light::count)
       break;
     // light_buffer.push_back(pipeline::Light(light, o_tm.has_value() ? o_tm->position :
     // glm::vec3()));
-    light_buffer.push_back(
-        pipeline::Light(light, o_tm.has_value() ? o_tm->get_world().position : glm::vec3()));
+    light_buffer.push_back(pipeline::Light(light, world_position(o_tm, o_global)));
   }
 
   glBindBuffer(GL_UNIFORM_BUFFER, self.uboLights);
@@ -131,8 +133,15 @@ void cevy::engine::ForwardRenderer::render_system(
   glUniformMatrix4fv(self.shaderProgram->uniform("invView"), 1, GL_FALSE, glm::value_ptr(invView));
 
   // std::cout << "rendering " << models.size() << " models" << std::endl;
-  for (auto [o_tm, model, o_material, o_color] : models) {
-    auto tm = o_tm ? o_tm->get_world().mat4() : glm::mat4(1);
+  self.drawMatrices.clear();
+  for (auto [o_tm, o_global, model, o_material, o_color] : models) {
+    self.drawMatrices.push(world_matrix(o_tm, o_global), model->modelMatrix(),
+                           model->tNormalMatrix());
+  }
+  self.drawMatrices.compute();
+
+  size_t draw = 0;
+  for (auto [o_tm, o_global, model, o_material, o_color] : models) {
     glm::vec4 white = glm::vec4(1, 1, 1, 1);
     auto &color = o_color ? o_color.value().as_vec() : white;
     const PbrMaterial &material = o_material ? o_material->get() : self.defaultMaterial;
@@ -146,9 +155,10 @@ void cevy::engine::ForwardRenderer::render_system(
     glUniform1f(self.shaderProgram->uniform("phong_exponent"), material.phong_exponent);
     glUniform1i(self.shaderProgram->uniform("halflambert"), true);
     glUniformMatrix4fv(self.shaderProgram->uniform("model"), 1, GL_FALSE,
-                       glm::value_ptr(tm * model->modelMatrix()));
+                       glm::value_ptr(self.drawMatrices.model(draw)));
     glUniformMatrix3fv(self.shaderProgram->uniform("model_normal"), 1, GL_TRUE,
-                       glm::value_ptr(model->tNormalMatrix() * glm::inverse(glm::mat3(tm))));
+                       glm::value_ptr(self.drawMatrices.normal(draw)));
+    draw += 1;
     glUniform1i(self.shaderProgram->uniform("has_texture"), model->tex_coordinates.size() != 0);
 
     if (material.diffuse_texture.has_value()) {
@@ -9,6 +9,8 @@
 
 #include "Camera.hpp"
 #include "Color.hpp"
+#include "DrawMatrices.hpp"
+#include "GlobalTransform.hpp"
 #include "Handle.hpp"
 #include "Model.hpp"
 #include "PbrMaterial.hpp"
@@ -54,8 +56,11 @@ class cevy::engine::ForwardRenderer {
   void init();
   void static render_system(
       ForwardRenderer &self, Query<Camera> cams,
-      Query<option<Transform>, Handle<Model>, option<Handle<PbrMaterial>>, option<Color>> models,
-      Query<option<Transform>, cevy::engine::PointLight> lights, const cevy::ecs::World &world);
+      Query<option<Transform>, option<GlobalTransform>, Handle<Model>, option<Handle<PbrMaterial>>,
+            option<Color>>
+          models,
+      Query<option<Transform>, option<GlobalTransform>, cevy::engine::PointLight> lights,
+      const cevy::ecs::World &world);
 
   protected:
   GLFWwindow *glfWindow;
@@ -63,4 +68,6 @@ class cevy::engine::ForwardRenderer {
   ShaderProgram *shaderProgram;
 
   PbrMaterial defaultMaterial;
+  /// matrices of the draws of the frame
+  DrawMatrices drawMatrices;
 };
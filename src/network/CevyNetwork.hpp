@@ -14,10 +14,12 @@
 #include <cstring>
 #include <iostream>
 #include <list>
+#include <memory>
 #include <optional>
 #include <unordered_map>
 #include <vector>
 
+#include "EventChannel.hpp"
 #include "NetworkBase.hpp"
 #include "network.hpp"
 
@@ -89,6 +91,7 @@ class cevy::CevyNetwork : public cevy::NetworkBase {
   }
 
   std::optional<std::vector<uint8_t>> recvState(uint16_t id) {
+    receive();
     const auto &it = _states_recv.find(id);
     if (it != _states_recv.end()) {
       auto ret = std::move(it->second);
@@ -109,6 +112,7 @@ class cevy::CevyNetwork : public cevy::NetworkBase {
   }
 
   std::optional<std::vector<uint8_t>> recvEvent(uint16_t id) {
+    receive();
     const auto &it =
         std::find_if(_events_recv.begin(), _events_recv.end(), [id](std::vector<uint8_t> &a) {
           return a[0] == byte(id, 0) && a[1] == byte(id, 1);
@@ -193,26 +197,48 @@ class cevy::CevyNetwork : public cevy::NetworkBase {
   }
 
   private:
-  void handle_state(size_t bytes, std::array<uint8_t, 512> &buffer) {
+  /// Sort the packets received by the network thread, from the thread reading them
+  void receive() {
+    _inbox->drain([this](std::vector<uint8_t> &&packet) { handle_packet(packet); });
+  }
+
+  void handle_packet(std::vector<uint8_t> &packet) {
+    if (packet[0] == (uint8_t)Communication::State) {
+      return handle_state(packet);
+    }
+    if (packet[0] == (uint8_t)Communication::ActionSuccess ||
+        packet[0] == (uint8_t)Communication::ActionFailure ||
+        packet[0] == (uint8_t)Communication::Action) {
+      return handle_action(packet);
+    }
+    if (packet[0] == (uint8_t)Communication::Event) {
+      return handle_events(packet);
+    }
+  }
+
+  void handle_state(std::vector<uint8_t> &packet) {
     uint64_t id;
-    std::memcpy(&id, &buffer[1], sizeof(id));
+    std::memcpy(&id, &packet[1], sizeof(id));
     std::vector<uint8_t> vec;
-    vec.insert(vec.begin(), buffer.begin() + 3, buffer.begin() + bytes - 3);
+    vec.insert(vec.begin(), packet.begin() + 3, packet.end() - 3);
     _states_recv[id] = vec;
   }
 
-  void handle_action(size_t bytes, std::array<uint8_t, 512> &buffer) {
-    std::vector<uint8_t> vec;
-    vec.insert(vec.begin(), buffer.begin(), buffer.begin() + bytes);
-    _actions_recv.push_front(vec);
-  }
+  void handle_action(std::vector<uint8_t> &packet) { _actions_recv.push_front(packet); }
 
-  void handle_events(size_t bytes, std::array<uint8_t, 512> &buffer) {
+  void handle_events(std::vector<uint8_t> &packet) {
     std::vector<uint8_t> vec;
-    vec.insert(vec.begin(), buffer.begin() + 1, buffer.begin() + bytes - 1);
+    vec.insert(vec.begin(), packet.begin() + 1, packet.end() - 1);
     _events_recv.push_front(vec);
   }
 
+  /// Called on the network thread, the packet is only queued
+  void post_packet(size_t bytes, const std::array<uint8_t, 512> &buffer) {
+    if (!_inbox->push(std::vector<uint8_t>(buffer.begin(), buffer.begin() + bytes))) {
+      std::cerr << "WARNING/Cevy: network inbox full, packet dropped" << std::endl;
+    }
+  }
+
   protected:
   void udp_receive(std::error_code error, size_t bytes, std::array<uint8_t, 512> &buffer,
                    asio::ip::udp::endpoint &) override {
@@ -222,17 +248,7 @@ class cevy::CevyNetwork : public cevy::NetworkBase {
     }
     if (bytes <= 0)
       return;
-    if (buffer[0] == (uint8_t)Communication::State) {
-      return handle_state(bytes, buffer);
-    }
-    if (buffer[0] == (uint8_t)Communication::ActionSuccess ||
-        buffer[0] == (uint8_t)Communication::ActionFailure ||
-        buffer[0] == (uint8_t)Communication::Action) {
-      return handle_action(bytes, buffer);
-    }
-    if (buffer[0] == (uint8_t)Communication::Event) {
-      return handle_events(bytes, buffer);
-    }
+    post_packet(bytes, buffer);
   }
 
   void tcp_receive(std::error_code error, size_t bytes, TcpConnexion &co) override {
@@ -242,20 +258,14 @@ class cevy::CevyNetwork : public cevy::NetworkBase {
     }
     if (bytes <= 0)
       return;
-    if (co.buffer[0] == (uint8_t)Communication::State) {
-      return handle_state(bytes, co.buffer);
-    }
-    if (co.buffer[0] == (uint8_t)Communication::ActionSuccess ||
-        co.buffer[0] == (uint8_t)Communication::ActionFailure ||
-        co.buffer[0] == (uint8_t)Communication::Action) {
-      return handle_action(bytes, co.buffer);
-    }
-    if (co.buffer[0] == (uint8_t)Communication::Event) {
-      return handle_events(bytes, co.buffer);
-    }
+    post_packet(bytes, co.buffer);
   }
 
   private:
+  // packets received by the network thread, sorted into the buffers below by receive()
+  std::shared_ptr<ecs::EventChannel<std::vector<uint8_t>>> _inbox =
+      std::make_shared<ecs::EventChannel<std::vector<uint8_t>>>();
+
   // the data part contains only pure state data
   std::unordered_map<uint16_t, std::vector<uint8_t>> _states_recv;
   std::unordered_map<uint16_t, std::vector<uint8_t>> _states_send;
@@ -8,28 +8,109 @@
 #include "Physics.hpp"
 #include "App.hpp"
 #include "Collider.hpp"
-#include "DefaultPlugin.hpp"
+#include "ContactCache.hpp"
+#include "GlobalTransform.hpp"
+#include "Query.hpp"
+#include "SpatialHash.hpp"
+#include "SweepAndPrune.hpp"
+#include "TaskPool.hpp"
+#include "Transform.hpp"
+#include "TreeBroadphase.hpp"
 #include "ecs.hpp"
 
-void checkCollision(cevy::ecs::World &world) {
-  cevy::physics::Grid grid;
-  grid.setGrid(world);
-
-  for (std::size_t x = 0; x < grid.getCells().size(); x++) {
-    for (std::size_t y = 0; y < grid.getCells()[x].value().size(); y++) {
-      for (std::size_t z = 0; z < grid.getCells()[x].value()[y].value().size(); z++) {
-        if (grid.getCells()[x].value()[y].value()[z] != std::nullopt) {
-          for (auto &entity : grid.getCells()[x].value()[y].value()[z].value()) {
-            grid.collisionWithNeighboringEntities(entity);
-          }
-        }
-      }
-    }
+#include <optional>
+#include <utility>
+
+using cevy::ecs::Entity;
+using cevy::ecs::RemovedComponents;
+using cevy::ecs::TaskPool;
+using cevy::engine::GlobalTransform;
+using cevy::engine::Transform;
+using cevy::physics::BroadphasePairs;
+using cevy::physics::Collider;
+using cevy::physics::CollisionEnded;
+using cevy::physics::CollisionStarted;
+using cevy::physics::ContactCache;
+using cevy::physics::SpatialHash;
+using cevy::physics::SweepAndPrune;
+using cevy::physics::TreeBroadphase;
+
+/* runs before the colliders are updated, so that a new collider reusing the id of a
+   removed one starts without its proxy nor its contacts */
+template <typename Broadphase>
+static void drop_removed(cevy::ecs::Resource<RemovedComponents<Collider>> removed,
+                         cevy::ecs::Resource<Broadphase> broadphase,
+                         cevy::ecs::Resource<ContactCache> contacts,
+                         cevy::ecs::EventWriter<CollisionEnded> ended) {
+  for (size_t entity : removed->entities) {
+    broadphase->remove(entity);
   }
+  contacts->remove(removed->entities, [&ended](Entity first, Entity second) {
+    ended.send(CollisionEnded {first, second});
+  });
+  removed->entities.clear();
+}
+
+template <typename Broadphase>
+static void update_broadphase(
+    cevy::ecs::Query<cevy::ecs::Entity, Collider, Transform, option<GlobalTransform>> colliders,
+    cevy::ecs::Resource<Broadphase> broadphase, cevy::ecs::Resource<BroadphasePairs> pairs) {
+  for (auto [entity, collider, transform, global] : colliders) {
+    const Transform &world = global ? global->transform() : transform.get_world();
+
+    collider.shape.set_transform(world.position, world.rotation);
+    broadphase->update(entity, collider.shape.bounds());
+  }
+  broadphase->sweep();
+  broadphase->pairs(pairs->pairs);
+}
+
+static void narrowphase(cevy::ecs::Query<cevy::ecs::Entity, Collider> colliders,
+                        cevy::ecs::Resource<BroadphasePairs> pairs,
+                        cevy::ecs::Resource<ContactCache> contacts,
+                        cevy::ecs::EventWriter<CollisionStarted> started,
+                        cevy::ecs::EventWriter<CollisionEnded> ended,
+                        std::optional<cevy::ecs::Resource<TaskPool>> pool) {
+  for (auto [first, second] : pairs->pairs) {
+    auto [entity1, collider1] = *colliders.from(first);
+    auto [entity2, collider2] = *colliders.from(second);
+
+    contacts->push(entity1, entity2, collider1.shape, collider2.shape);
+  }
+  contacts->update_pushed(
+      pool ? &pool->get() : nullptr,
+      [&started](Entity first, Entity second) { started.send(CollisionStarted {first, second}); },
+      [&ended](Entity first, Entity second) { ended.send(CollisionEnded {first, second}); });
+  contacts->end_frame([&ended](Entity first, Entity second) {
+    ended.send(CollisionEnded {first, second});
+  });
+}
+
+template <typename Broadphase, typename... Params>
+static void add_broadphase(cevy::ecs::App &app, Params &&...params) {
+  app.init_resource<Broadphase>(std::forward<Params>(params)...);
+  app.add_systems<cevy::ecs::core_stage::Update>(drop_removed<Broadphase>,
+                                                 update_broadphase<Broadphase>, narrowphase)
+      .chain()
+      .in_set("physics");
 }
 
 void cevy::physics::PhysicsPlugin::build(cevy::ecs::App &app) {
-  app.add_plugins(cevy::ecs::DefaultPlugin());
   app.init_component<cevy::physics::Collider>();
-  app.add_system<cevy::ecs::Schedule::Update>(checkCollision);
+  app.init_resource<BroadphasePairs>();
+  app.init_resource<ContactCache>();
+  app.init_resource<RemovedComponents<Collider>>();
+  app.add_event<CollisionStarted>();
+  app.add_event<CollisionEnded>();
+  switch (broadphase) {
+  case BroadphaseKind::SpatialHash:
+    add_broadphase<SpatialHash>(app, cell_size);
+    break;
+  case BroadphaseKind::SweepAndPrune:
+    add_broadphase<SweepAndPrune>(app);
+    break;
+  case BroadphaseKind::DynamicTree:
+    add_broadphase<TreeBroadphase>(app, margin);
+    break;
+  }
 }
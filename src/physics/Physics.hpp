@@ -8,13 +8,53 @@
 #pragma once
 
 #include "Plugin.hpp"
-#include "Schedule.hpp"
 #include "ecs.hpp"
 
 namespace cevy::physics {
 using namespace cevy::ecs;
+
+/// Broadphase used by the PhysicsPlugin, see Broadphase
+enum class BroadphaseKind {
+  /// Uniform cells, for colliders of similar sizes, moving a lot
+  SpatialHash,
+  /// Sorted bounds, for mostly static or slowly moving colliders
+  SweepAndPrune,
+  /// Trees of boxes, for colliders of very different sizes, many of them static
+  DynamicTree,
+};
+
+/**
+ * @brief Collision detection between the entities with a Collider and a Transform
+ *
+ * Every frame, the broadphase resource is updated with the bounding box of each collider,
+ * it puts the candidate pairs in the BroadphasePairs resource, which are then tested with
+ * their shapes. The broadphase resource is the SpatialHash, the SweepAndPrune or the
+ * TreeBroadphase, which can also be queried with a box or a ray.
+ * The ContactCache resource keeps the result of the tests from one frame to the next,
+ * CollisionStarted and CollisionEnded events are sent when shapes start or stop touching.
+ * With a TaskPool resource, the shapes of many pairs are tested over its threads, the events
+ * stay the same.
+ * The systems are in the "physics" set, in the Update stage.
+ * Requires the DefaultPlugin, and the Transform and GlobalTransform components registered
+ * by the Engine.
+ * '''
+ * app.add_plugins(PhysicsPlugin(BroadphaseKind::SweepAndPrune));
+ * '''
+ */
 class PhysicsPlugin : public Plugin {
   public:
-  void build(App &app);
+  /**
+   * cell_size: size of the cells of the SpatialHash, about the size of the common colliders
+   * margin: added around the boxes in the TreeBroadphase, about the distance moved in a frame
+   */
+  PhysicsPlugin(BroadphaseKind broadphase = BroadphaseKind::SpatialHash, float cell_size = 50,
+                float margin = 1)
+      : broadphase(broadphase), cell_size(cell_size), margin(margin) {}
+
+  void build(App &app) override;
+
+  BroadphaseKind broadphase;
+  float cell_size;
+  float margin;
 };
 } // namespace cevy::physics
@@ -0,0 +1,156 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Overlap tests over arrays of boxes
+*/
+
+#include "BoxBatch.hpp"
+
+#include <algorithm>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+using cevy::engine::AABB;
+using cevy::engine::Vector;
+using cevy::physics::BoxArrays;
+using cevy::physics::Broadphase;
+
+void BoxArrays::set(size_t id, const AABB &box) {
+  if (id >= _size) {
+    for (size_t axis = 0; axis < 3; ++axis) {
+      _min[axis].resize(id + batch::lanes);
+      _max[axis].resize(id + batch::lanes);
+    }
+    _size = id + 1;
+  }
+  _min[0][id] = box.min.x;
+  _min[1][id] = box.min.y;
+  _min[2][id] = box.min.z;
+  _max[0][id] = box.max.x;
+  _max[1][id] = box.max.y;
+  _max[2][id] = box.max.z;
+}
+
+AABB BoxArrays::get(size_t id) const {
+  return AABB(Vector(_min[0][id], _min[1][id], _min[2][id]),
+              Vector(_max[0][id], _max[1][id], _max[2][id]));
+}
+
+void BoxArrays::clear() {
+  for (size_t axis = 0; axis < 3; ++axis) {
+    _min[axis].clear();
+    _max[axis].clear();
+  }
+  _size = 0;
+}
+
+/* same test as AABB::intersects */
+static bool overlap(const BoxArrays &boxes, size_t a, size_t b) {
+  for (size_t axis = 0; axis < 3; ++axis) {
+    if (boxes.min(axis)[a] > boxes.max(axis)[b] || boxes.min(axis)[b] > boxes.max(axis)[a]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#ifdef __AVX__
+/* values of the first or second box of 8 pairs, AVX has no gather instruction */
+template <bool second>
+static inline __m256 gather(const float *values, const Broadphase::Pair *pairs) {
+  auto at = [&](size_t lane) { return values[second ? pairs[lane].second : pairs[lane].first]; };
+
+  return _mm256_setr_ps(at(0), at(1), at(2), at(3), at(4), at(5), at(6), at(7));
+}
+#endif
+
+size_t cevy::physics::batch::overlapping(const BoxArrays &boxes, const Broadphase::Pair *pairs,
+                                         size_t count, Broadphase::Pair *out) {
+  size_t kept = 0;
+  size_t i = 0;
+
+#ifdef __AVX__
+  for (; i + lanes <= count; i += lanes) {
+    Broadphase::Pair batch[lanes];
+    __m256 overlaps = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+    /* out may be pairs, the batch is copied before being overwritten */
+    std::copy(pairs + i, pairs + i + lanes, batch);
+    for (size_t axis = 0; axis < 3; ++axis) {
+      __m256 min_a = gather<false>(boxes.min(axis), batch);
+      __m256 max_a = gather<false>(boxes.max(axis), batch);
+      __m256 min_b = gather<true>(boxes.min(axis), batch);
+      __m256 max_b = gather<true>(boxes.max(axis), batch);
+
+      overlaps = _mm256_and_ps(overlaps, _mm256_cmp_ps(min_a, max_b, _CMP_LE_OQ));
+      overlaps = _mm256_and_ps(overlaps, _mm256_cmp_ps(min_b, max_a, _CMP_LE_OQ));
+    }
+    int mask = _mm256_movemask_ps(overlaps);
+
+    for (size_t lane = 0; lane < lanes; ++lane) {
+      out[kept] = batch[lane];
+      kept += (mask >> lane) & 1;
+    }
+  }
+#endif
+  return kept + overlapping_scalar(boxes, pairs + i, count - i, out + kept);
+}
+
+size_t cevy::physics::batch::overlapping_scalar(const BoxArrays &boxes,
+                                                const Broadphase::Pair *pairs, size_t count,
+                                                Broadphase::Pair *out) {
+  size_t kept = 0;
+
+  for (size_t i = 0; i < count; ++i) {
+    Broadphase::Pair pair = pairs[i];
+
+    if (overlap(boxes, pair.first, pair.second)) {
+      out[kept++] = pair;
+    }
+  }
+  return kept;
+}
+
+size_t cevy::physics::batch::overlapping(const BoxArrays &boxes, size_t index, size_t first,
+                                         size_t last, uint32_t *out) {
+  size_t kept = 0;
+  size_t i = first;
+
+#ifdef __AVX__
+  __m256 min[3];
+  __m256 max[3];
+
+  for (size_t axis = 0; axis < 3; ++axis) {
+    min[axis] = _mm256_set1_ps(boxes.min(axis)[index]);
+    max[axis] = _mm256_set1_ps(boxes.max(axis)[index]);
+  }
+  /* the last batch reads the padding, masked out */
+  for (; i < last; i += lanes) {
+    __m256 overlaps = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+    for (size_t axis = 0; axis < 3; ++axis) {
+      __m256 other_min = _mm256_loadu_ps(boxes.min(axis) + i);
+      __m256 other_max = _mm256_loadu_ps(boxes.max(axis) + i);
+
+      overlaps = _mm256_and_ps(overlaps, _mm256_cmp_ps(min[axis], other_max, _CMP_LE_OQ));
+      overlaps = _mm256_and_ps(overlaps, _mm256_cmp_ps(other_min, max[axis], _CMP_LE_OQ));
+    }
+    int mask = _mm256_movemask_ps(overlaps);
+    size_t valid = std::min(lanes, last - i);
+
+    mask &= (1 << valid) - 1;
+    for (size_t lane = 0; lane < valid; ++lane) {
+      out[kept] = uint32_t(i + lane);
+      kept += (mask >> lane) & 1;
+    }
+  }
+#endif
+  for (; i < last; ++i) {
+    out[kept] = uint32_t(i);
+    kept += overlap(boxes, index, i);
+  }
+  return kept;
+}
@@ -0,0 +1,82 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Overlap tests over arrays of boxes
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "AABB.hpp"
+#include "Broadphase.hpp"
+
+namespace cevy::physics {
+namespace batch {
+/// Number of boxes or pairs tested at once with AVX
+static constexpr size_t lanes = 8;
+} // namespace batch
+
+/**
+ * @brief Boxes stored as one array per coordinate, indexed by collider id
+ *
+ * The layout read by the batch kernels, filled by the broadphases along with their own
+ * structures. lanes - 1 floats of padding follow the last box, so that the kernels load
+ * whole batches from any box.
+ */
+class BoxArrays {
+  public:
+  /// Store the box of id, growing the arrays if needed
+  void set(size_t id, const engine::AABB &box);
+
+  engine::AABB get(size_t id) const;
+
+  void clear();
+
+  size_t size() const { return _size; }
+
+  const float *min(size_t axis) const { return _min[axis].data(); }
+  const float *max(size_t axis) const { return _max[axis].data(); }
+
+  protected:
+  std::vector<float> _min[3];
+  std::vector<float> _max[3];
+  size_t _size = 0;
+};
+
+/**
+ * @brief Overlap tests of candidate pairs, after the broadphase found them
+ *
+ * '''
+ * pairs.resize(batch::overlapping(boxes, pairs.data(), pairs.size(), pairs.data()));
+ * size_t found = batch::overlapping(boxes, i, i + 1, boxes.size(), indices.data());
+ * '''
+ */
+namespace batch {
+/**
+ * @brief Keep the pairs whose boxes overlap, in order, returns their number
+ *
+ * With AVX, the coordinates of 8 pairs are loaded in registers and compared at once,
+ * every pair is then written and only the overlapping ones are kept, without a branch.
+ * out may be pairs.
+ */
+size_t overlapping(const BoxArrays &boxes, const Broadphase::Pair *pairs, size_t count,
+                   Broadphase::Pair *out);
+
+/// Same as overlapping, one pair at a time
+size_t overlapping_scalar(const BoxArrays &boxes, const Broadphase::Pair *pairs, size_t count,
+                          Broadphase::Pair *out);
+
+/**
+ * @brief Indices in [first, last) of the boxes overlapping the box at index, in order
+ *
+ * With AVX, 8 boxes are loaded and compared at once. out must hold last - first indices,
+ * returns the number written.
+ */
+size_t overlapping(const BoxArrays &boxes, size_t index, size_t first, size_t last,
+                   uint32_t *out);
+} // namespace batch
+} // namespace cevy::physics
@@ -0,0 +1,57 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Broadphase interface
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "AABB.hpp"
+
+namespace cevy::physics {
+/**
+ * @brief Interface of the broadphases, finding the colliders whose boxes overlap
+ *
+ * Colliders are identified by their entity id, and are kept from one frame to the next.
+ * '''
+ * broadphase.update(entity, box); // for every collider, every frame
+ * broadphase.sweep();             // forget the colliders which were not updated
+ * broadphase.pairs(pairs);
+ * '''
+ */
+class Broadphase {
+  public:
+  /// Ids of two colliders, first < second
+  using Pair = std::pair<size_t, size_t>;
+
+  virtual ~Broadphase() = default;
+
+  /// Insert the collider id, or move it to box
+  virtual void update(size_t id, const engine::AABB &box) = 0;
+
+  virtual void remove(size_t id) = 0;
+
+  /// Remove every collider which was not updated since the last sweep
+  virtual void sweep() = 0;
+
+  virtual void clear() = 0;
+
+  virtual bool contains(size_t id) const = 0;
+
+  /// Number of colliders
+  virtual size_t size() const = 0;
+
+  /// Every pair of colliders whose boxes overlap, once, sorted
+  virtual void pairs(std::vector<Pair> &out) = 0;
+};
+
+/// Resource holding the pairs found by the broadphase this frame, for the narrowphase
+struct BroadphasePairs {
+  std::vector<Broadphase::Pair> pairs;
+};
+} // namespace cevy::physics
@@ -1,16 +0,0 @@
-/*
-** EPITECH PROJECT, 2023
-** R-Type
-** File description:
-** Collider.cpp
-*/
-
-#include "Collider.hpp"
-#include "Position.hpp"
-#include "Rotation.hpp"
-#include "ecs.hpp"
-#include <cstdio>
-#include <optional>
-#include <tuple>
-
-using namespace cevy::physics;
@@ -7,54 +7,23 @@
 
 #pragma once
 
-#include <algorithm>
-#include <memory>
-
-#include "Position.hpp"
-#include "Rotation.hpp"
-#include "SparseVector.hpp"
-#include "World.hpp"
-
 #include "Shape.hpp"
-#include "ecs.hpp"
-#include <tuple>
-#include <utility>
-#include <vector>
+#include "World.hpp"
 
 namespace cevy::physics {
-
-enum CELL_SIZE {
-  X = 50,
-  Y = 50,
-  Z = 50,
+/**
+ * @brief Component giving a Shape to an entity, placed at the position of its Transform
+ *
+ * The shape is stored inline, updated by the PhysicsPlugin with the world transform of
+ * the entity.
+ */
+struct Collider {
+  Collider(const Shape &shape) : shape(shape) {}
+
+  Shape shape;
 };
-class Collider {
-  private:
-  std::unique_ptr<Shape> _shape;
-
-  public:
-  template <typename GivenShape>
-  Collider(std::unique_ptr<GivenShape> shape) : _shape(std::move(shape)) {
-    static_assert(std::is_base_of<Shape, GivenShape>::value, "GivenShape must derive from Shape");
-  }
-  ~Collider() = default;
+} // namespace cevy::physics
 
-  Shape &getShape() const { return *_shape; }
-};
-
-using entity =
-    std::tuple<const Collider &, const cevy::engine::Position &, const cevy::engine::Rotation &>;
-class Grid {
-  private:
-  SparseVector<SparseVector<SparseVector<std::vector<entity>>>> _cells;
-
-  public:
-  Grid() {};
-  ~Grid() {};
-
-  SparseVector<SparseVector<SparseVector<std::vector<entity>>>> getCells() const { return _cells; };
-  void addEntity(const size_t x, const size_t y, const size_t z, const entity &value);
-  void setGrid(cevy::ecs::World &world);
-  void collisionWithNeighboringEntities(const entity &entity1);
-};
-} // namespace cevy::physics
\ No newline at end of file
+/// the ids of despawned colliders are reused at once, the PhysicsPlugin drops their contacts
+template <>
+struct cevy::ecs::track_removals<cevy::physics::Collider> : std::true_type {};
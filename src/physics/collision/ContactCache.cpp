@@ -0,0 +1,41 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Persistent contacts between colliders
+*/
+
+#include "ContactCache.hpp"
+
+using cevy::physics::ContactCache;
+
+const ContactCache::Contact *ContactCache::find(size_t a, size_t b) const {
+  auto it = _contacts.find(key(a, b));
+
+  return it == _contacts.end() ? nullptr : &it->second;
+}
+
+void ContactCache::push(Entity first, Entity second, const Shape &first_shape,
+                        const Shape &second_shape) {
+  _pushed.push_back(Pushed {first, second, &first_shape, &second_shape});
+}
+
+void ContactCache::test_pushed(size_t first, size_t last) {
+  /* only reads the contacts, the batches run at the same time */
+  for (size_t i = first; i < last; ++i) {
+    const Pushed &pair = _pushed[i];
+    const Contact *contact = find(pair.first, pair.second);
+
+    if (!contact || !same_shapes(*contact, *pair.first_shape, *pair.second_shape)) {
+      _touching[i] = pair.first_shape->intersects(*pair.second_shape);
+    }
+  }
+}
+
+void ContactCache::clear() {
+  _contacts.clear();
+  _removed.clear();
+  _pushed.clear();
+  _frame = 0;
+  _reused = 0;
+}
@@ -0,0 +1,255 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Persistent contacts between colliders
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Entity.hpp"
+#include "Shape.hpp"
+#include "TaskPool.hpp"
+
+namespace cevy::physics {
+using cevy::ecs::Entity;
+
+/// Sent when the shapes of two colliders start touching, first < second
+struct CollisionStarted {
+  Entity first;
+  Entity second;
+};
+
+/// Sent when the shapes of two colliders stop touching, or one of them is removed
+struct CollisionEnded {
+  Entity first;
+  Entity second;
+};
+
+/**
+ * @brief Pairs found by the broadphase, kept from one frame to the next
+ *
+ * Each contact remembers whether the shapes touch, and the shapes it was tested with:
+ * a pair whose shapes didn't move is not tested again.
+ * Comparing with the last frame gives the contacts which start, stay or end.
+ * Added as a Resource by the PhysicsPlugin.
+ * '''
+ * for (auto [a, b] : pairs)
+ *   contacts.update(a, b, shape_a, shape_b, [&]() { return shape_a.intersects(shape_b); });
+ * contacts.end_frame([](Entity a, Entity b) { ... });
+ * '''
+ * The pairs may also be pushed, then tested together over the TaskPool by update_pushed.
+ */
+class ContactCache {
+  public:
+  /// Pushed pairs from which the TaskPool is used
+  static constexpr size_t parallel_threshold = 4096;
+  /// Pairs tested per task
+  static constexpr size_t grain = 1024;
+
+  struct Contact {
+    Entity first;
+    Entity second;
+    /// shapes of the colliders when they were last tested
+    Shape first_shape;
+    Shape second_shape;
+    bool touching = false;
+    size_t frame = 0;
+  };
+
+  enum class Change { None, Started, Ended };
+
+  /**
+   * @brief Record a pair found by the broadphase this frame
+   *
+   * test() tells whether the shapes touch, it is only called for a new pair, or when one
+   * of the shapes changed since the pair was last tested.
+   * Returns whether the contact started or ended.
+   */
+  template <typename Test>
+  Change update(Entity first, Entity second, const Shape &first_shape, const Shape &second_shape,
+                Test &&test);
+
+  /**
+   * @brief Forget the pairs which were not updated since the last call
+   *
+   * ended(first, second) is called for those which were touching, in order.
+   */
+  template <typename Func>
+  void end_frame(Func &&ended);
+
+  /**
+   * @brief Forget the pairs of removed colliders, before their ids are updated again
+   *
+   * ended(first, second) is called for those which were touching, in order.
+   * A new collider given the id of a removed one then starts without contacts.
+   */
+  template <typename Func>
+  void remove(const std::vector<Entity> &removed, Func &&ended);
+
+  /// Add a pair for update_pushed, the shapes must live until then
+  void push(Entity first, Entity second, const Shape &first_shape, const Shape &second_shape);
+
+  /**
+   * @brief update() every pushed pair, in the order they were pushed, then forget them
+   *
+   * The tests are run first, above parallel_threshold pairs in batches of grain pairs over
+   * the TaskPool: each batch writes the results of its own pairs, and the cache is only
+   * changed afterwards. started(first, second) and ended(first, second) are called in order,
+   * the same for any number of threads.
+   */
+  template <typename Started, typename Ended>
+  void update_pushed(ecs::TaskPool *pool, Started &&started, Ended &&ended);
+
+  /// Number of pairs waiting for update_pushed
+  size_t pushed() const { return _pushed.size(); }
+
+  /// Contact between two colliders, null when the broadphase didn't find the pair
+  const Contact *find(size_t a, size_t b) const;
+
+  bool touching(size_t a, size_t b) const {
+    const Contact *contact = find(a, b);
+
+    return contact && contact->touching;
+  }
+
+  /// Number of pairs, touching or not
+  size_t size() const { return _contacts.size(); }
+
+  /// Number of tests skipped because the shapes didn't move
+  size_t reused() const { return _reused; }
+
+  void clear();
+
+  protected:
+  static uint64_t key(size_t a, size_t b) {
+    return a < b ? uint64_t(a) << 32 | b : uint64_t(b) << 32 | a;
+  }
+
+  struct Pushed {
+    Entity first;
+    Entity second;
+    const Shape *first_shape;
+    const Shape *second_shape;
+  };
+
+  /// Whether a contact can be reused, without testing its shapes again
+  static bool same_shapes(const Contact &contact, const Shape &first_shape,
+                          const Shape &second_shape) {
+    return contact.first_shape == first_shape && contact.second_shape == second_shape;
+  }
+
+  /// Fill _touching with the tests of the pushed pairs in [first, last)
+  void test_pushed(size_t first, size_t last);
+
+  /// Erase the pairs of _stale, calling ended for the touching ones in order
+  template <typename Func>
+  void erase_stale(Func &&ended);
+
+  std::unordered_map<uint64_t, Contact> _contacts;
+  std::vector<uint64_t> _stale;
+  std::vector<size_t> _removed;
+  std::vector<Pushed> _pushed;
+  /// result of each pushed pair, not set for those which are reused
+  std::vector<uint8_t> _touching;
+  size_t _frame = 0;
+  size_t _reused = 0;
+};
+
+template <typename Test>
+ContactCache::Change ContactCache::update(Entity first, Entity second, const Shape &first_shape,
+                                          const Shape &second_shape, Test &&test) {
+  auto [it, inserted] = _contacts.try_emplace(key(first, second),
+                                              Contact {first, second, first_shape, second_shape});
+  Contact &contact = it->second;
+  bool was_touching = contact.touching;
+
+  if (inserted || !same_shapes(contact, first_shape, second_shape)) {
+    contact.first_shape = first_shape;
+    contact.second_shape = second_shape;
+    contact.touching = test();
+  } else {
+    _reused += 1;
+  }
+  contact.frame = _frame;
+  if (contact.touching == was_touching) {
+    return Change::None;
+  }
+  return contact.touching ? Change::Started : Change::Ended;
+}
+
+template <typename Started, typename Ended>
+void ContactCache::update_pushed(ecs::TaskPool *pool, Started &&started, Ended &&ended) {
+  _touching.resize(_pushed.size());
+  if (pool && pool->size() > 1 && _pushed.size() >= parallel_threshold) {
+    pool->parallel_for(_pushed.size(), grain,
+                       [this](size_t first, size_t last) { test_pushed(first, last); });
+  } else {
+    test_pushed(0, _pushed.size());
+  }
+  for (size_t i = 0; i < _pushed.size(); ++i) {
+    const Pushed &pair = _pushed[i];
+    Change change = update(pair.first, pair.second, *pair.first_shape, *pair.second_shape,
+                           [&]() { return bool(_touching[i]); });
+
+    if (change == Change::Started) {
+      started(pair.first, pair.second);
+    } else if (change == Change::Ended) {
+      ended(pair.first, pair.second);
+    }
+  }
+  _pushed.clear();
+}
+
+template <typename Func>
+void ContactCache::end_frame(Func &&ended) {
+  _stale.clear();
+  for (auto &[pair, contact] : _contacts) {
+    if (contact.frame != _frame) {
+      _stale.push_back(pair);
+    }
+  }
+  erase_stale(ended);
+  _frame += 1;
+}
+
+template <typename Func>
+void ContactCache::remove(const std::vector<Entity> &removed, Func &&ended) {
+  if (removed.empty()) {
+    return;
+  }
+  _removed.assign(removed.begin(), removed.end());
+  std::sort(_removed.begin(), _removed.end());
+  auto is_removed = [this](size_t id) {
+    return std::binary_search(_removed.begin(), _removed.end(), id);
+  };
+
+  _stale.clear();
+  for (auto &[pair, contact] : _contacts) {
+    if (is_removed(contact.first) || is_removed(contact.second)) {
+      _stale.push_back(pair);
+    }
+  }
+  erase_stale(ended);
+}
+
+template <typename Func>
+void ContactCache::erase_stale(Func &&ended) {
+  /* the order of the map changes with its size, the events must not */
+  std::sort(_stale.begin(), _stale.end());
+  for (uint64_t pair : _stale) {
+    auto it = _contacts.find(pair);
+
+    if (it->second.touching) {
+      ended(it->second.first, it->second.second);
+    }
+    _contacts.erase(it);
+  }
+}
+} // namespace cevy::physics
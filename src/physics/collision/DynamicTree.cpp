@@ -0,0 +1,258 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Dynamic AABB tree
+*/
+
+#include "DynamicTree.hpp"
+
+#include <algorithm>
+
+using cevy::engine::AABB;
+using cevy::engine::Vector;
+using cevy::physics::DynamicTree;
+
+/* half the surface of the box, the cost of testing it */
+static float perimeter(const AABB &box) {
+  Vector size = box.max - box.min;
+
+  return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+DynamicTree::DynamicTree(float margin) : _margin(margin) {}
+
+int32_t DynamicTree::create(size_t id, const AABB &box) {
+  int32_t proxy = allocate();
+
+  _nodes[proxy].box = fatten(box);
+  _nodes[proxy].id = id;
+  _nodes[proxy].height = 0;
+  insert_leaf(proxy);
+  _leaves += 1;
+  return proxy;
+}
+
+void DynamicTree::destroy(int32_t proxy) {
+  remove_leaf(proxy);
+  release(proxy);
+  _leaves -= 1;
+}
+
+bool DynamicTree::move(int32_t proxy, const AABB &box) {
+  Node &leaf = _nodes[proxy];
+
+  if (leaf.box.contains(box)) {
+    return false;
+  }
+  /* refitting in place would grow the ancestors along the whole path of a moving proxy */
+  remove_leaf(proxy);
+  _nodes[proxy].box = fatten(box);
+  insert_leaf(proxy);
+  return true;
+}
+
+void DynamicTree::clear() {
+  _nodes.clear();
+  _root = null_node;
+  _free = null_node;
+  _leaves = 0;
+}
+
+float DynamicTree::area_ratio() const {
+  if (_root == null_node || _nodes[_root].leaf()) {
+    return 0;
+  }
+  float root = perimeter(_nodes[_root].box);
+  float total = 0;
+
+  for (const Node &node : _nodes) {
+    if (node.height > 0) {
+      total += perimeter(node.box);
+    }
+  }
+  return root > 0 ? total / root : 0;
+}
+
+bool DynamicTree::validate() const {
+  if (_root == null_node) {
+    return _leaves == 0;
+  }
+  return _nodes[_root].parent == null_node && validate(_root);
+}
+
+bool DynamicTree::validate(int32_t index) const {
+  const Node &node = _nodes[index];
+
+  if (node.leaf()) {
+    return node.right == null_node && node.height == 0;
+  }
+  const Node &left = _nodes[node.left];
+  const Node &right = _nodes[node.right];
+
+  return left.parent == index && right.parent == index &&
+         node.height == 1 + std::max(left.height, right.height) &&
+         node.box == left.box.merge(right.box) &&
+         validate(node.left) && validate(node.right);
+}
+
+int32_t DynamicTree::allocate() {
+  if (_free == null_node) {
+    _nodes.emplace_back();
+    return int32_t(_nodes.size() - 1);
+  }
+  int32_t index = _free;
+
+  _free = _nodes[index].parent;
+  _nodes[index] = Node();
+  return index;
+}
+
+void DynamicTree::release(int32_t index) {
+  _nodes[index].parent = _free;
+  _nodes[index].height = -1;
+  _free = index;
+}
+
+void DynamicTree::insert_leaf(int32_t leaf) {
+  if (_root == null_node) {
+    _root = leaf;
+    _nodes[leaf].parent = null_node;
+    return;
+  }
+  const AABB box = _nodes[leaf].box;
+  int32_t index = _root;
+
+  /* descend towards the child whose surface grows the least, stop when making a new
+     parent here costs less */
+  while (!_nodes[index].leaf()) {
+    const Node &node = _nodes[index];
+    float area = perimeter(node.box);
+    float combined = perimeter(node.box.merge(box));
+    float cost = 2 * combined;
+    float inheritance = 2 * (combined - area);
+    auto descend_cost = [&](int32_t child) {
+      const AABB &child_box = _nodes[child].box;
+      float grown = perimeter(child_box.merge(box));
+
+      return _nodes[child].leaf() ? grown + inheritance
+                                  : grown - perimeter(child_box) + inheritance;
+    };
+    float left = descend_cost(node.left);
+    float right = descend_cost(node.right);
+
+    if (cost < left && cost < right) {
+      break;
+    }
+    index = left < right ? node.left : node.right;
+  }
+
+  int32_t sibling = index;
+  int32_t old_parent = _nodes[sibling].parent;
+  int32_t parent = allocate();
+
+  _nodes[parent].parent = old_parent;
+  _nodes[parent].box = _nodes[sibling].box.merge(box);
+  _nodes[parent].height = _nodes[sibling].height + 1;
+  _nodes[parent].left = sibling;
+  _nodes[parent].right = leaf;
+  _nodes[sibling].parent = parent;
+  _nodes[leaf].parent = parent;
+  if (old_parent == null_node) {
+    _root = parent;
+  } else if (_nodes[old_parent].left == sibling) {
+    _nodes[old_parent].left = parent;
+  } else {
+    _nodes[old_parent].right = parent;
+  }
+  refit(_nodes[leaf].parent);
+}
+
+void DynamicTree::remove_leaf(int32_t leaf) {
+  if (leaf == _root) {
+    _root = null_node;
+    return;
+  }
+  int32_t parent = _nodes[leaf].parent;
+  int32_t grand_parent = _nodes[parent].parent;
+  int32_t sibling = _nodes[parent].left == leaf ? _nodes[parent].right : _nodes[parent].left;
+
+  release(parent);
+  _nodes[sibling].parent = grand_parent;
+  if (grand_parent == null_node) {
+    _root = sibling;
+    return;
+  }
+  if (_nodes[grand_parent].left == parent) {
+    _nodes[grand_parent].left = sibling;
+  } else {
+    _nodes[grand_parent].right = sibling;
+  }
+  refit(grand_parent);
+}
+
+int32_t DynamicTree::balance(int32_t a) {
+  Node &node_a = _nodes[a];
+
+  if (node_a.leaf() || node_a.height < 2) {
+    return a;
+  }
+  int32_t b = node_a.left;
+  int32_t c = node_a.right;
+  int32_t difference = _nodes[c].height - _nodes[b].height;
+
+  if (difference >= -1 && difference <= 1) {
+    return a;
+  }
+  /* the higher child takes the place of a, a keeps its lower grand child and takes
+     the higher one's place */
+  bool right_higher = difference > 1;
+  int32_t up = right_higher ? c : b;
+  int32_t other = right_higher ? b : c;
+  Node &node_up = _nodes[up];
+  int32_t f = node_up.left;
+  int32_t g = node_up.right;
+
+  node_up.left = a;
+  node_up.parent = node_a.parent;
+  node_a.parent = up;
+  if (node_up.parent == null_node) {
+    _root = up;
+  } else if (_nodes[node_up.parent].left == a) {
+    _nodes[node_up.parent].left = up;
+  } else {
+    _nodes[node_up.parent].right = up;
+  }
+
+  int32_t kept = _nodes[f].height > _nodes[g].height ? f : g;
+  int32_t given = kept == f ? g : f;
+
+  node_up.right = kept;
+  (right_higher ? node_a.right : node_a.left) = given;
+  _nodes[given].parent = a;
+  node_a.box = _nodes[other].box.merge(_nodes[given].box);
+  node_a.height = 1 + std::max(_nodes[other].height, _nodes[given].height);
+  node_up.box = node_a.box.merge(_nodes[kept].box);
+  node_up.height = 1 + std::max(node_a.height, _nodes[kept].height);
+  return up;
+}
+
+void DynamicTree::refit(int32_t index) {
+  while (index != null_node) {
+    index = balance(index);
+
+    Node &node = _nodes[index];
+    const Node &left = _nodes[node.left];
+    const Node &right = _nodes[node.right];
+
+    node.height = 1 + std::max(left.height, right.height);
+    node.box = left.box.merge(right.box);
+    index = node.parent;
+  }
+}
+
+AABB DynamicTree::fatten(const AABB &box) const {
+  Vector margin(_margin, _margin, _margin);
+
+  return AABB(box.min - margin, box.max + margin);
+}
@@ -0,0 +1,211 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Dynamic AABB tree
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "AABB.hpp"
+
+namespace cevy::physics {
+/**
+ * @brief Bounding volume hierarchy of fattened boxes, updated as they move
+ *
+ * Each leaf stores the box of a proxy grown by margin on every side, so small moves stay
+ * inside it and cost nothing. A proxy leaving its fat box is reinserted with a new fat box,
+ * so that its ancestors never stretch along its path. Leaves are inserted next to the sibling
+ * growing the tree surface the least, and AVL rotations keep the tree balanced.
+ * Nodes live in a single vector, referred to by index, released nodes are reused.
+ * '''
+ * int32_t proxy = tree.create(id, box);
+ * tree.move(proxy, moved);
+ * tree.query(area, [&](int32_t proxy) { found.push_back(tree.id(proxy)); return true; });
+ * '''
+ */
+class DynamicTree {
+  public:
+  static constexpr int32_t null_node = -1;
+
+  DynamicTree(float margin = 1);
+
+  float margin() const { return _margin; }
+
+  /// Insert a leaf for box, returns its proxy
+  int32_t create(size_t id, const engine::AABB &box);
+
+  void destroy(int32_t proxy);
+
+  /// Move the proxy to box, returns false when box is still inside its fat box
+  bool move(int32_t proxy, const engine::AABB &box);
+
+  void clear();
+
+  const engine::AABB &fat_box(int32_t proxy) const { return _nodes[proxy].box; }
+
+  size_t id(int32_t proxy) const { return _nodes[proxy].id; }
+
+  /// Number of leaves
+  size_t size() const { return _leaves; }
+
+  /// Height of the root, 0 for a single leaf
+  int32_t height() const { return _root == null_node ? 0 : _nodes[_root].height; }
+
+  /**
+   * @brief Surface of every internal node over the one of the root
+   *
+   * The expected cost of a query, relative to testing the root alone, 0 without internal node.
+   */
+  float area_ratio() const;
+
+  /**
+   * @brief Call func(proxy) for every leaf whose fat box overlaps box
+   *
+   * The traversal stops when func returns false.
+   */
+  template <typename Func>
+  void query(const engine::AABB &box, Func &&func) const;
+
+  /**
+   * @brief Call func(proxy, max_distance) for every leaf whose fat box the ray hits
+   *
+   * The ray goes from origin along direction, up to max_distance lengths of direction.
+   * func returns the new max_distance, to clip the ray to the closest hit so far, or a
+   * value <= 0 to stop the traversal.
+   */
+  template <typename Func>
+  void raycast(const engine::Vector &origin, const engine::Vector &direction,
+               float max_distance, Func &&func) const;
+
+  /// Whether the links, heights and boxes of every node are consistent
+  bool validate() const;
+
+  protected:
+  /// Nodes left to visit by a traversal, on the stack of the caller unless the tree is very deep
+  class Stack {
+    public:
+    static constexpr size_t capacity = 64;
+
+    bool empty() const { return _size == 0; }
+
+    void push(int32_t node) {
+      if (_size < capacity) {
+        _fixed[_size] = node;
+      } else {
+        _overflow.push_back(node);
+      }
+      _size += 1;
+    }
+
+    int32_t pop() {
+      _size -= 1;
+      if (_size < capacity) {
+        return _fixed[_size];
+      }
+      int32_t node = _overflow.back();
+
+      _overflow.pop_back();
+      return node;
+    }
+
+    protected:
+    int32_t _fixed[capacity];
+    std::vector<int32_t> _overflow;
+    size_t _size = 0;
+  };
+
+  struct Node {
+    engine::AABB box;
+    /// next free node, for the released ones
+    int32_t parent = null_node;
+    int32_t left = null_node;
+    int32_t right = null_node;
+    /// 0 for the leaves, -1 for the released nodes
+    int32_t height = 0;
+    size_t id = 0;
+
+    bool leaf() const { return left == null_node; }
+  };
+
+  int32_t allocate();
+  void release(int32_t node);
+
+  void insert_leaf(int32_t leaf);
+  void remove_leaf(int32_t leaf);
+
+  /// Rotate the child of node up when its subtrees differ by more than 1 in height
+  int32_t balance(int32_t node);
+
+  /// Balance node and its ancestors, recomputing their boxes and heights
+  void refit(int32_t node);
+
+  engine::AABB fatten(const engine::AABB &box) const;
+
+  bool validate(int32_t node) const;
+
+  std::vector<Node> _nodes;
+  int32_t _root = null_node;
+  int32_t _free = null_node;
+  size_t _leaves = 0;
+  float _margin;
+};
+
+template <typename Func>
+void DynamicTree::query(const engine::AABB &box, Func &&func) const {
+  Stack stack;
+
+  if (_root != null_node) {
+    stack.push(_root);
+  }
+  while (!stack.empty()) {
+    int32_t index = stack.pop();
+    const Node &node = _nodes[index];
+
+    if (!node.box.intersects(box)) {
+      continue;
+    }
+    if (node.leaf()) {
+      if (!func(index)) {
+        return;
+      }
+    } else {
+      stack.push(node.left);
+      stack.push(node.right);
+    }
+  }
+}
+
+template <typename Func>
+void DynamicTree::raycast(const engine::Vector &origin, const engine::Vector &direction,
+                          float max_distance, Func &&func) const {
+  engine::Vector inverse(1 / direction.x, 1 / direction.y, 1 / direction.z);
+  Stack stack;
+  float distance;
+
+  if (_root != null_node) {
+    stack.push(_root);
+  }
+  while (!stack.empty()) {
+    int32_t index = stack.pop();
+    const Node &node = _nodes[index];
+
+    if (!node.box.raycast(origin, inverse, max_distance, distance)) {
+      continue;
+    }
+    if (node.leaf()) {
+      max_distance = func(index, max_distance);
+      if (max_distance <= 0) {
+        return;
+      }
+    } else {
+      stack.push(node.left);
+      stack.push(node.right);
+    }
+  }
+}
+} // namespace cevy::physics
@@ -5,15 +5,270 @@
 ** Shape.cpp
 */
 
-#include "Collider.hpp"
-
-bool cevy::physics::Cuboid::calculateCollision(cevy::physics::Shape &other) {
-  cevy::physics::Cuboid *cube = dynamic_cast<cevy::physics::Cuboid *>(&other);
-  bool collisionX = _position.x + _dimension.x >= cube->getPosition().x &&
-                    cube->getPosition().x + cube->getDimension().x >= _position.x;
-  bool collisionY = _position.y + _dimension.y >= cube->getPosition().y &&
-                    cube->getPosition().y + cube->getDimension().y >= _position.y;
-  bool collisionZ = _position.z + _dimension.z >= cube->getPosition().z &&
-                    cube->getPosition().z + cube->getDimension().z >= _position.z;
-  return collisionX && collisionY && collisionZ;
-}
\ No newline at end of file
+#include "Shape.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using cevy::engine::AABB;
+using cevy::engine::Vector;
+using cevy::physics::Shape;
+
+/* covers the rounding of the rotations, so that parallel edges don't separate the boxes */
+static constexpr float epsilon = 1e-6f;
+
+static float component(const Vector &v, size_t i) { return (&v.x)[i]; }
+
+Shape::Shape(Type type, const Vector &extents)
+    : _extents(extents), _axes {Vector(1, 0, 0), Vector(0, 1, 0), Vector(0, 0, 1)},
+      _type(type) {}
+
+Shape Shape::sphere(float radius) { return Shape(Type::Sphere, Vector(radius, radius, radius)); }
+
+Shape Shape::box(const Vector &half_extents) { return Shape(Type::Box, half_extents); }
+
+Shape Shape::oriented_box(const Vector &half_extents) {
+  return Shape(Type::OrientedBox, half_extents);
+}
+
+Shape Shape::capsule(float radius, float half_height) {
+  return Shape(Type::Capsule, Vector(radius, half_height, radius));
+}
+
+void Shape::set_transform(const Vector &position, const glm::quat &rotation) {
+  _position = position;
+  if (_type == Type::OrientedBox || _type == Type::Capsule) {
+    _axes[0] = rotation * glm::vec3(1, 0, 0);
+    _axes[1] = rotation * glm::vec3(0, 1, 0);
+    _axes[2] = rotation * glm::vec3(0, 0, 1);
+  }
+}
+
+AABB Shape::bounds() const {
+  Vector half;
+
+  switch (_type) {
+  case Type::Sphere:
+  case Type::Box:
+    half = _extents;
+    break;
+  case Type::OrientedBox:
+    for (size_t i = 0; i < 3; ++i) {
+      Vector axis(std::abs(_axes[i].x), std::abs(_axes[i].y), std::abs(_axes[i].z));
+      half += axis * component(_extents, i);
+    }
+    break;
+  case Type::Capsule: {
+    Vector axis(std::abs(_axes[1].x), std::abs(_axes[1].y), std::abs(_axes[1].z));
+    half = axis * _extents.y + Vector(radius(), radius(), radius());
+    break;
+  }
+  }
+  return AABB(_position - half, _position + half);
+}
+
+/* point of the box, oriented or not, closest to point */
+static Vector closest_in_box(const Shape &box, const Vector &point) {
+  Vector offset = point - box.position();
+  Vector closest = box.position();
+
+  for (size_t i = 0; i < 3; ++i) {
+    float extent = component(box.extents(), i);
+
+    closest += box.axis(i) * std::clamp(offset * box.axis(i), -extent, extent);
+  }
+  return closest;
+}
+
+static Vector closest_on_segment(const Vector &start, const Vector &end, const Vector &point) {
+  Vector direction = end - start;
+  float length = direction.eval();
+
+  if (length <= epsilon) {
+    return start;
+  }
+  return start + direction * std::clamp((point - start) * direction / length, 0.f, 1.f);
+}
+
+/* squared distance between the segments [p1, q1] and [p2, q2] */
+static float segments_distance(const Vector &p1, const Vector &q1, const Vector &p2,
+                               const Vector &q2) {
+  Vector d1 = q1 - p1;
+  Vector d2 = q2 - p2;
+  Vector r = p1 - p2;
+  float a = d1.eval();
+  float e = d2.eval();
+  float f = d2 * r;
+  float s = 0;
+  float t = 0;
+
+  if (a <= epsilon && e <= epsilon) {
+    return r.eval();
+  }
+  if (a <= epsilon) {
+    t = std::clamp(f / e, 0.f, 1.f);
+  } else if (e <= epsilon) {
+    s = std::clamp(-(d1 * r) / a, 0.f, 1.f);
+  } else {
+    float b = d1 * d2;
+    float c = d1 * r;
+    float denominator = a * e - b * b;
+
+    /* parallel segments, any s works */
+    s = denominator > 0 ? std::clamp((b * f - c * e) / denominator, 0.f, 1.f) : 0;
+    t = (b * s + f) / e;
+    if (t < 0) {
+      t = 0;
+      s = std::clamp(-c / a, 0.f, 1.f);
+    } else if (t > 1) {
+      t = 1;
+      s = std::clamp((b - c) / a, 0.f, 1.f);
+    }
+  }
+  return ((p1 + d1 * s) - (p2 + d2 * t)).eval();
+}
+
+static Vector capsule_start(const Shape &capsule) {
+  return capsule.position() - capsule.axis(1) * capsule.extents().y;
+}
+
+static Vector capsule_end(const Shape &capsule) {
+  return capsule.position() + capsule.axis(1) * capsule.extents().y;
+}
+
+static bool sphere_sphere(const Shape &a, const Shape &b) {
+  float radius = a.radius() + b.radius();
+
+  return (a.position() - b.position()).eval() <= radius * radius;
+}
+
+/* box or oriented box */
+static bool sphere_box(const Shape &sphere, const Shape &box) {
+  Vector offset = closest_in_box(box, sphere.position()) - sphere.position();
+
+  return offset.eval() <= sphere.radius() * sphere.radius();
+}
+
+static bool sphere_capsule(const Shape &sphere, const Shape &capsule) {
+  Vector closest = closest_on_segment(capsule_start(capsule), capsule_end(capsule),
+                                      sphere.position());
+  float radius = sphere.radius() + capsule.radius();
+
+  return (closest - sphere.position()).eval() <= radius * radius;
+}
+
+static bool box_box(const Shape &a, const Shape &b) { return a.bounds().intersects(b.bounds()); }
+
+/* separating axis test of two oriented boxes: their 3 + 3 face normals, and the 9 cross
+   products of their edges */
+static bool oriented_box_box(const Shape &a, const Shape &b) {
+  float rotation[3][3];
+  float absolute[3][3];
+  float t[3];
+  Vector offset = b.position() - a.position();
+
+  for (size_t i = 0; i < 3; ++i) {
+    for (size_t j = 0; j < 3; ++j) {
+      rotation[i][j] = a.axis(i) * b.axis(j);
+      absolute[i][j] = std::abs(rotation[i][j]) + epsilon;
+    }
+    t[i] = offset * a.axis(i);
+  }
+
+  for (size_t i = 0; i < 3; ++i) {
+    float ra = component(a.extents(), i);
+    float rb = b.extents().x * absolute[i][0] + b.extents().y * absolute[i][1] +
+               b.extents().z * absolute[i][2];
+
+    if (std::abs(t[i]) > ra + rb) {
+      return false;
+    }
+  }
+  for (size_t j = 0; j < 3; ++j) {
+    float ra = a.extents().x * absolute[0][j] + a.extents().y * absolute[1][j] +
+               a.extents().z * absolute[2][j];
+    float rb = component(b.extents(), j);
+    float distance = t[0] * rotation[0][j] + t[1] * rotation[1][j] + t[2] * rotation[2][j];
+
+    if (std::abs(distance) > ra + rb) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < 3; ++i) {
+    size_t i1 = (i + 1) % 3;
+    size_t i2 = (i + 2) % 3;
+
+    for (size_t j = 0; j < 3; ++j) {
+      size_t j1 = (j + 1) % 3;
+      size_t j2 = (j + 2) % 3;
+      float ra = component(a.extents(), i1) * absolute[i2][j] +
+                 component(a.extents(), i2) * absolute[i1][j];
+      float rb = component(b.extents(), j1) * absolute[i][j2] +
+                 component(b.extents(), j2) * absolute[i][j1];
+      float distance = t[i2] * rotation[i1][j] - t[i1] * rotation[i2][j];
+
+      if (std::abs(distance) > ra + rb) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/* the distance from the segment to the box is convex along the segment, its minimum is
+   found by golden section search */
+static bool capsule_box(const Shape &capsule, const Shape &box) {
+  Vector start = capsule_start(capsule);
+  Vector direction = capsule_end(capsule) - start;
+  auto distance = [&](float t) {
+    Vector point = start + direction * t;
+
+    return (closest_in_box(box, point) - point).eval();
+  };
+  constexpr float ratio = 0.618034f;
+  float low = 0;
+  float high = 1;
+  float radius = capsule.radius() * capsule.radius();
+
+  for (size_t i = 0; i < 32 && high - low > epsilon; ++i) {
+    float left = high - (high - low) * ratio;
+    float right = low + (high - low) * ratio;
+    float left_distance = distance(left);
+
+    if (left_distance <= radius) {
+      return true;
+    }
+    if (left_distance < distance(right)) {
+      high = right;
+    } else {
+      low = left;
+    }
+  }
+  return std::min({distance(low), distance(high), distance(0), distance(1)}) <= radius;
+}
+
+static bool capsule_capsule(const Shape &a, const Shape &b) {
+  float radius = a.radius() + b.radius();
+
+  return segments_distance(capsule_start(a), capsule_end(a), capsule_start(b), capsule_end(b)) <=
+         radius * radius;
+}
+
+using Routine = bool (*)(const Shape &, const Shape &);
+
+template <Routine routine>
+static bool swapped(const Shape &a, const Shape &b) {
+  return routine(b, a);
+}
+
+/* indexed by the types of both shapes, in the order of Shape::Type */
+static const Routine collision_table[Shape::types][Shape::types] = {
+    {sphere_sphere, sphere_box, sphere_box, sphere_capsule},
+    {swapped<sphere_box>, box_box, oriented_box_box, swapped<capsule_box>},
+    {swapped<sphere_box>, oriented_box_box, oriented_box_box, swapped<capsule_box>},
+    {swapped<sphere_capsule>, capsule_box, capsule_box, capsule_capsule},
+};
+
+bool Shape::intersects(const Shape &other) const {
+  return collision_table[size_t(_type)][size_t(other._type)](*this, other);
+}
@@ -0,0 +1,211 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Spatial hash broadphase
+*/
+
+#include "SpatialHash.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using cevy::engine::AABB;
+using cevy::engine::Vector;
+using cevy::physics::SpatialHash;
+
+/* keeps the cell coordinates, and the size of their ranges, within int32_t */
+static constexpr float max_cell = 1 << 30;
+
+SpatialHash::SpatialHash(float cell_size)
+    : _cell_size(cell_size), _inverse_cell_size(1 / cell_size), _slots(16) {}
+
+void SpatialHash::update(size_t id, const AABB &box) {
+  Range range = range_of(box);
+
+  if (id >= _proxies.size()) {
+    _proxies.resize(id + 1);
+  }
+  Proxy &proxy = _proxies[id];
+  if (!proxy.active) {
+    proxy.active = true;
+    _count += 1;
+    insert_cells(id, range);
+  } else if (!(proxy.range == range)) {
+    erase_cells(id, proxy.range);
+    insert_cells(id, range);
+  }
+  proxy.range = range;
+  _boxes.set(id, box);
+  proxy.epoch = _epoch;
+}
+
+void SpatialHash::remove(size_t id) {
+  if (!contains(id)) {
+    return;
+  }
+  erase_cells(id, _proxies[id].range);
+  _proxies[id].active = false;
+  _count -= 1;
+}
+
+void SpatialHash::sweep() {
+  for (size_t id = 0; id < _proxies.size(); ++id) {
+    if (_proxies[id].active && _proxies[id].epoch != _epoch) {
+      remove(id);
+    }
+  }
+  _epoch += 1;
+}
+
+void SpatialHash::clear() {
+  _slots.assign(16, Slot());
+  _used = 0;
+  _erased = 0;
+  _proxies.clear();
+  _boxes.clear();
+  _count = 0;
+}
+
+void SpatialHash::pairs(std::vector<Pair> &out) {
+  out.clear();
+  for (auto &slot : _slots) {
+    size_t count = slot.ids.size();
+
+    if (slot.state != State::Used || count < 2) {
+      continue;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      _cell_boxes.set(i, _boxes.get(slot.ids[i]));
+    }
+    _found.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+      const Proxy &a = _proxies[slot.ids[i]];
+      size_t found = batch::overlapping(_cell_boxes, i, i + 1, count, _found.data());
+
+      for (size_t k = 0; k < found; ++k) {
+        size_t j = _found[k];
+        const Proxy &b = _proxies[slot.ids[j]];
+        Cell first = {std::max(a.range.min.x, b.range.min.x),
+                      std::max(a.range.min.y, b.range.min.y),
+                      std::max(a.range.min.z, b.range.min.z)};
+
+        if (first == slot.key) {
+          out.emplace_back(std::min(slot.ids[i], slot.ids[j]),
+                           std::max(slot.ids[i], slot.ids[j]));
+        }
+      }
+    }
+  }
+  std::sort(out.begin(), out.end());
+}
+
+SpatialHash::Cell SpatialHash::cell_of(const Vector &point) const {
+  auto coordinate = [this](float value) {
+    return int32_t(std::clamp(std::floor(value * _inverse_cell_size), -max_cell, max_cell));
+  };
+
+  return Cell {coordinate(point.x), coordinate(point.y), coordinate(point.z)};
+}
+
+SpatialHash::Range SpatialHash::range_of(const AABB &box) const {
+  return Range {cell_of(box.min), cell_of(box.max)};
+}
+
+template <typename Func>
+void SpatialHash::for_each_cell(const Range &range, Func &&func) {
+  for (int32_t x = range.min.x; x <= range.max.x; ++x) {
+    for (int32_t y = range.min.y; y <= range.max.y; ++y) {
+      for (int32_t z = range.min.z; z <= range.max.z; ++z) {
+        func(Cell {x, y, z});
+      }
+    }
+  }
+}
+
+void SpatialHash::insert_cells(size_t id, const Range &range) {
+  for_each_cell(range, [this, id](const Cell &cell) { find_or_insert(cell).ids.push_back(id); });
+}
+
+void SpatialHash::erase_cells(size_t id, const Range &range) {
+  for_each_cell(range, [this, id](const Cell &cell) {
+    Slot *slot = find(cell);
+
+    if (!slot) {
+      return;
+    }
+    auto it = std::find(slot->ids.begin(), slot->ids.end(), id);
+    if (it != slot->ids.end()) {
+      *it = slot->ids.back();
+      slot->ids.pop_back();
+    }
+    if (slot->ids.empty()) {
+      slot->state = State::Erased;
+      _used -= 1;
+      _erased += 1;
+    }
+  });
+}
+
+SpatialHash::Slot *SpatialHash::find(const Cell &key) {
+  size_t mask = _slots.size() - 1;
+
+  for (size_t i = hash(key) & mask;; i = (i + 1) & mask) {
+    Slot &slot = _slots[i];
+
+    if (slot.state == State::Empty) {
+      return nullptr;
+    }
+    if (slot.state == State::Used && slot.key == key) {
+      return &slot;
+    }
+  }
+}
+
+SpatialHash::Slot &SpatialHash::find_or_insert(const Cell &key) {
+  if (Slot *slot = find(key)) {
+    return *slot;
+  }
+  if ((_used + _erased + 1) * 2 > _slots.size()) {
+    rehash(_used * 4 > _slots.size() ? _slots.size() * 2 : _slots.size());
+  }
+  size_t mask = _slots.size() - 1;
+  size_t i = hash(key) & mask;
+  while (_slots[i].state == State::Used) {
+    i = (i + 1) & mask;
+  }
+  Slot &slot = _slots[i];
+  if (slot.state == State::Erased) {
+    _erased -= 1;
+  }
+  slot.key = key;
+  slot.state = State::Used;
+  _used += 1;
+  return slot;
+}
+
+void SpatialHash::rehash(size_t capacity) {
+  std::vector<Slot> slots(capacity);
+  size_t mask = capacity - 1;
+
+  std::swap(slots, _slots);
+  for (auto &slot : slots) {
+    if (slot.state != State::Used) {
+      continue;
+    }
+    size_t i = hash(slot.key) & mask;
+    while (_slots[i].state != State::Empty) {
+      i = (i + 1) & mask;
+    }
+    _slots[i] = std::move(slot);
+  }
+  _erased = 0;
+}
+
+size_t SpatialHash::hash(const Cell &cell) {
+  uint32_t h = uint32_t(cell.x) * 73856093u ^ uint32_t(cell.y) * 19349663u ^
+               uint32_t(cell.z) * 83492791u;
+
+  /* fibonacci hashing, spreading the bits to the low ones kept by the mask */
+  return size_t((uint64_t(h) * 0x9e3779b97f4a7c15ull) >> 32);
+}
@@ -0,0 +1,119 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Spatial hash broadphase
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "AABB.hpp"
+#include "BoxBatch.hpp"
+#include "Broadphase.hpp"
+
+namespace cevy::physics {
+/**
+ * @brief Broadphase storing colliders in a flat hash table of uniform cells
+ *
+ * Cells are keyed by their integer coordinates, floor(position / cell_size), so negative
+ * positions get their own cells. The table is open addressed with linear probing.
+ * update() only touches the cells a collider enters or leaves.
+ * Colliders larger than a cell are stored in every cell they overlap.
+ */
+class SpatialHash final : public Broadphase {
+  public:
+  SpatialHash(float cell_size = 50);
+
+  float cell_size() const { return _cell_size; }
+
+  void update(size_t id, const engine::AABB &box) override;
+  void remove(size_t id) override;
+  void sweep() override;
+  void clear() override;
+
+  bool contains(size_t id) const override {
+    return id < _proxies.size() && _proxies[id].active;
+  }
+
+  size_t size() const override { return _count; }
+
+  /// Number of non empty cells
+  size_t cells() const { return _used; }
+
+  /**
+   * @brief Every pair of colliders whose boxes overlap, once, sorted
+   *
+   * A pair sharing several cells is only tested in the first one, the cell at the
+   * min corner of the cells they share. The boxes of a cell are copied next to each other,
+   * to be tested in batches.
+   */
+  void pairs(std::vector<Pair> &out) override;
+
+  protected:
+  struct Cell {
+    int32_t x;
+    int32_t y;
+    int32_t z;
+
+    bool operator==(const Cell &rhs) const { return x == rhs.x && y == rhs.y && z == rhs.z; }
+  };
+
+  /// Cells overlapped by a box, bounds included
+  struct Range {
+    Cell min;
+    Cell max;
+
+    bool operator==(const Range &rhs) const { return min == rhs.min && max == rhs.max; }
+  };
+
+  struct Proxy {
+    Range range;
+    size_t epoch = 0;
+    bool active = false;
+  };
+
+  enum class State : uint8_t { Empty, Used, Erased };
+
+  struct Slot {
+    Cell key;
+    State state = State::Empty;
+    std::vector<size_t> ids;
+  };
+
+  Cell cell_of(const engine::Vector &point) const;
+  Range range_of(const engine::AABB &box) const;
+
+  template <typename Func>
+  static void for_each_cell(const Range &range, Func &&func);
+
+  void insert_cells(size_t id, const Range &range);
+  void erase_cells(size_t id, const Range &range);
+
+  /// Slot of key, or null when the cell is empty
+  Slot *find(const Cell &key);
+  Slot &find_or_insert(const Cell &key);
+  void rehash(size_t capacity);
+  static size_t hash(const Cell &cell);
+
+  float _cell_size;
+  float _inverse_cell_size;
+
+  /// power of 2 slots, at most half Used or Erased
+  std::vector<Slot> _slots;
+  size_t _used = 0;
+  size_t _erased = 0;
+
+  /// indexed by collider id
+  std::vector<Proxy> _proxies;
+  BoxArrays _boxes;
+  /* boxes of the cell being tested, and the indices of the overlapping ones */
+  BoxArrays _cell_boxes;
+  std::vector<uint32_t> _found;
+  size_t _count = 0;
+  size_t _epoch = 0;
+};
+} // namespace cevy::physics
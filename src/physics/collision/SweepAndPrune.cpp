@@ -0,0 +1,170 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Sweep and prune broadphase
+*/
+
+#include "SweepAndPrune.hpp"
+
+#include <algorithm>
+
+using cevy::engine::AABB;
+using cevy::physics::SweepAndPrune;
+
+static float coordinate(const cevy::engine::Vector &v, size_t axis) { return (&v.x)[axis]; }
+
+void SweepAndPrune::update(size_t id, const AABB &box) {
+  if (id >= _proxies.size()) {
+    _proxies.resize(id + 1);
+  }
+  Proxy &proxy = _proxies[id];
+  if (!proxy.active) {
+    proxy.active = true;
+    _count += 1;
+    if (!proxy.inserted) {
+      proxy.inserted = true;
+      _inserted.push_back(id);
+    }
+  }
+  proxy.box = box;
+  proxy.epoch = _epoch;
+}
+
+void SweepAndPrune::remove(size_t id) {
+  if (!contains(id)) {
+    return;
+  }
+  _proxies[id].active = false;
+  _count -= 1;
+  _removed = true;
+}
+
+void SweepAndPrune::sweep() {
+  for (size_t id = 0; id < _proxies.size(); ++id) {
+    if (_proxies[id].active && _proxies[id].epoch != _epoch) {
+      remove(id);
+    }
+  }
+  _epoch += 1;
+}
+
+void SweepAndPrune::clear() {
+  for (auto &axis : _axes) {
+    axis.clear();
+  }
+  _proxies.clear();
+  _inserted.clear();
+  _pairs.clear();
+  _count = 0;
+  _removed = false;
+}
+
+void SweepAndPrune::pairs(std::vector<Pair> &out) {
+  refresh();
+  out.clear();
+  out.reserve(_pairs.size());
+  for (auto pair : _pairs) {
+    out.emplace_back(pair >> 32, pair & 0xffffffff);
+  }
+  std::sort(out.begin(), out.end());
+}
+
+void SweepAndPrune::refresh() {
+  if (_removed) {
+    auto removed = [this](const Bound &bound) { return !_proxies[bound.id].active; };
+
+    for (auto &axis : _axes) {
+      axis.erase(std::remove_if(axis.begin(), axis.end(), removed), axis.end());
+    }
+    for (auto it = _pairs.begin(); it != _pairs.end();) {
+      if (!_proxies[*it >> 32].active || !_proxies[*it & 0xffffffff].active) {
+        it = _pairs.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    for (auto &proxy : _proxies) {
+      proxy.inserted = proxy.active;
+    }
+    _removed = false;
+  }
+  if (_inserted.size() * 4 > _count) {
+    rebuild();
+    return;
+  }
+  /* new colliders start past every bound, and are sorted down to their place */
+  for (size_t axis = 0; axis < 3; ++axis) {
+    for (auto id : _inserted) {
+      if (_proxies[id].active) {
+        _axes[axis].push_back(Bound {0, id, false});
+        _axes[axis].push_back(Bound {0, id, true});
+      }
+    }
+  }
+  _inserted.clear();
+  for (size_t axis = 0; axis < 3; ++axis) {
+    for (auto &bound : _axes[axis]) {
+      const AABB &box = _proxies[bound.id].box;
+      bound.value = coordinate(bound.max ? box.max : box.min, axis);
+    }
+    sort(axis);
+  }
+}
+
+void SweepAndPrune::rebuild() {
+  std::vector<uint32_t> open;
+
+  _inserted.clear();
+  _pairs.clear();
+  for (size_t axis = 0; axis < 3; ++axis) {
+    _axes[axis].clear();
+    for (uint32_t id = 0; id < _proxies.size(); ++id) {
+      const AABB &box = _proxies[id].box;
+
+      _proxies[id].inserted = _proxies[id].active;
+      if (_proxies[id].active) {
+        _axes[axis].push_back(Bound {coordinate(box.min, axis), id, false});
+        _axes[axis].push_back(Bound {coordinate(box.max, axis), id, true});
+      }
+    }
+    std::sort(_axes[axis].begin(), _axes[axis].end(), less);
+  }
+  /* sweep the x axis, testing each collider with the ones open when it starts */
+  for (auto &bound : _axes[0]) {
+    if (bound.max) {
+      *std::find(open.begin(), open.end(), bound.id) = open.back();
+      open.pop_back();
+      continue;
+    }
+    for (auto other : open) {
+      if (_proxies[bound.id].box.intersects(_proxies[other].box)) {
+        _pairs.insert(key(bound.id, other));
+      }
+    }
+    open.push_back(bound.id);
+  }
+}
+
+void SweepAndPrune::sort(size_t axis) {
+  std::vector<Bound> &bounds = _axes[axis];
+
+  for (size_t i = 1; i < bounds.size(); ++i) {
+    Bound bound = bounds[i];
+    size_t j = i;
+
+    for (; j > 0 && less(bound, bounds[j - 1]); --j) {
+      const Bound &passed = bounds[j - 1];
+
+      if (!bound.max && passed.max) {
+        if (_proxies[bound.id].box.intersects(_proxies[passed.id].box)) {
+          _pairs.insert(key(bound.id, passed.id));
+        }
+      } else if (bound.max && !passed.max) {
+        _pairs.erase(key(bound.id, passed.id));
+      }
+      bounds[j] = passed;
+    }
+    bounds[j] = bound;
+  }
+}
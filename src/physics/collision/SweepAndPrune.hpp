@@ -0,0 +1,82 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Sweep and prune broadphase
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+#include "AABB.hpp"
+#include "Broadphase.hpp"
+
+namespace cevy::physics {
+/**
+ * @brief Broadphase keeping the bounds of the colliders sorted on each axis
+ *
+ * The 3 arrays of bounds are kept from one frame to the next, and sorted again with an
+ * insertion sort: when colliders move little, it is close to O(n).
+ * The overlapping pairs are kept too, and only change when a min bound and a max bound
+ * swap: a min passing a max may start an overlap, a max passing a min ends one.
+ * Updates and removals are applied by the next call to pairs(). When many colliders are
+ * inserted at once, as on the first frame, the axes are sorted and swept from scratch.
+ */
+class SweepAndPrune final : public Broadphase {
+  public:
+  void update(size_t id, const engine::AABB &box) override;
+  void remove(size_t id) override;
+  void sweep() override;
+  void clear() override;
+
+  bool contains(size_t id) const override {
+    return id < _proxies.size() && _proxies[id].active;
+  }
+
+  size_t size() const override { return _count; }
+
+  void pairs(std::vector<Pair> &out) override;
+
+  protected:
+  struct Bound {
+    float value;
+    uint32_t id;
+    bool max;
+  };
+
+  struct Proxy {
+    engine::AABB box;
+    size_t epoch = 0;
+    bool active = false;
+    /// its bounds are not in the axes yet
+    bool inserted = false;
+  };
+
+  /// Apply the removals and insertions, and sort the axes again
+  void refresh();
+  /// Sort the axes from scratch, when many colliders were inserted
+  void rebuild();
+  void sort(size_t axis);
+
+  /// Order of the bounds, at equal values mins come first: touching boxes overlap
+  static bool less(const Bound &a, const Bound &b) {
+    return a.value < b.value || (a.value == b.value && !a.max && b.max);
+  }
+
+  static uint64_t key(size_t a, size_t b) {
+    return a < b ? uint64_t(a) << 32 | b : uint64_t(b) << 32 | a;
+  }
+
+  std::vector<Bound> _axes[3];
+  std::vector<Proxy> _proxies;
+  std::vector<uint32_t> _inserted;
+  std::unordered_set<uint64_t> _pairs;
+  size_t _count = 0;
+  size_t _epoch = 0;
+  bool _removed = false;
+};
+} // namespace cevy::physics
@@ -0,0 +1,190 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Dynamic tree broadphase
+*/
+
+#include "TreeBroadphase.hpp"
+
+#include <algorithm>
+
+using cevy::engine::AABB;
+using cevy::engine::Vector;
+using cevy::physics::TreeBroadphase;
+
+TreeBroadphase::TreeBroadphase(float margin, size_t settle_frames)
+    : _static(margin), _dynamic(margin), _settle_frames(settle_frames) {}
+
+void TreeBroadphase::update(size_t id, const AABB &box) {
+  if (id >= _proxies.size()) {
+    _proxies.resize(id + 1);
+  }
+  Proxy &proxy = _proxies[id];
+  proxy.epoch = _epoch;
+  _boxes.set(id, box);
+  if (!proxy.active) {
+    proxy.active = true;
+    proxy.box = box;
+    proxy.still = 0;
+    proxy.node = _dynamic.create(id, box);
+    _count += 1;
+    return;
+  }
+  if (proxy.box == box) {
+    proxy.still += 1;
+    if (!proxy.is_static && proxy.still >= _settle_frames) {
+      settle(id);
+    }
+    return;
+  }
+  proxy.still = 0;
+  if (proxy.is_static) {
+    wake(id);
+    proxy.box = box;
+    proxy.node = _dynamic.create(id, box);
+  } else {
+    proxy.box = box;
+    _dynamic.move(proxy.node, box);
+  }
+}
+
+void TreeBroadphase::remove(size_t id) {
+  if (!contains(id)) {
+    return;
+  }
+  Proxy &proxy = _proxies[id];
+  if (proxy.is_static) {
+    wake(id);
+  } else {
+    _dynamic.destroy(proxy.node);
+  }
+  proxy.node = DynamicTree::null_node;
+  proxy.active = false;
+  _count -= 1;
+}
+
+void TreeBroadphase::sweep() {
+  for (size_t id = 0; id < _proxies.size(); ++id) {
+    if (_proxies[id].active && _proxies[id].epoch != _epoch) {
+      remove(id);
+    }
+  }
+  _epoch += 1;
+}
+
+void TreeBroadphase::clear() {
+  _static.clear();
+  _dynamic.clear();
+  _proxies.clear();
+  _boxes.clear();
+  _static_pairs.clear();
+  _count = 0;
+}
+
+void TreeBroadphase::pairs(std::vector<Pair> &out) {
+  out.clear();
+  out.reserve(_static_pairs.size());
+  for (auto pair : _static_pairs) {
+    out.emplace_back(pair >> 32, pair & 0xffffffff);
+  }
+  size_t candidates = out.size();
+
+  /* the trees hold fat boxes, the candidates are then tested with the boxes in batches */
+  for (size_t id = 0; id < _proxies.size(); ++id) {
+    const Proxy &proxy = _proxies[id];
+
+    if (!proxy.active || proxy.is_static) {
+      continue;
+    }
+    /* each dynamic pair is found from both sides, kept from its min id */
+    _dynamic.query(proxy.box, [&](int32_t node) {
+      size_t other = _dynamic.id(node);
+
+      if (id < other) {
+        out.emplace_back(id, other);
+      }
+      return true;
+    });
+    _static.query(proxy.box, [&](int32_t node) {
+      size_t other = _static.id(node);
+
+      out.emplace_back(std::min(id, other), std::max(id, other));
+      return true;
+    });
+  }
+  out.resize(candidates + batch::overlapping(_boxes, out.data() + candidates,
+                                             out.size() - candidates, out.data() + candidates));
+  std::sort(out.begin(), out.end());
+}
+
+void TreeBroadphase::query(const AABB &box, std::vector<size_t> &out) const {
+  auto collect = [&](const DynamicTree &tree) {
+    tree.query(box, [&](int32_t node) {
+      size_t id = tree.id(node);
+
+      if (box.intersects(_proxies[id].box)) {
+        out.push_back(id);
+      }
+      return true;
+    });
+  };
+
+  out.clear();
+  collect(_static);
+  collect(_dynamic);
+  std::sort(out.begin(), out.end());
+}
+
+bool TreeBroadphase::raycast(const Vector &origin, const Vector &direction, float max_distance,
+                             RayHit &hit) const {
+  Vector inverse(1 / direction.x, 1 / direction.y, 1 / direction.z);
+  bool found = false;
+  auto closest = [&](const DynamicTree &tree) {
+    tree.raycast(origin, direction, max_distance, [&](int32_t node, float max) {
+      size_t id = tree.id(node);
+      float distance;
+
+      /* the tree holds fat boxes, the collider box may be further or missed */
+      if (!_proxies[id].box.raycast(origin, inverse, max, distance)) {
+        return max;
+      }
+      found = true;
+      hit = RayHit {id, distance};
+      max_distance = distance;
+      return distance;
+    });
+  };
+
+  closest(_static);
+  closest(_dynamic);
+  return found;
+}
+
+void TreeBroadphase::settle(size_t id) {
+  Proxy &proxy = _proxies[id];
+
+  _dynamic.destroy(proxy.node);
+  _static.query(proxy.box, [&](int32_t node) {
+    size_t other = _static.id(node);
+
+    if (proxy.box.intersects(_proxies[other].box)) {
+      _static_pairs.insert(key(id, other));
+    }
+    return true;
+  });
+  proxy.node = _static.create(id, proxy.box);
+  proxy.is_static = true;
+}
+
+void TreeBroadphase::wake(size_t id) {
+  Proxy &proxy = _proxies[id];
+
+  _static.destroy(proxy.node);
+  _static.query(proxy.box, [&](int32_t node) {
+    _static_pairs.erase(key(id, _static.id(node)));
+    return true;
+  });
+  proxy.node = DynamicTree::null_node;
+  proxy.is_static = false;
+}
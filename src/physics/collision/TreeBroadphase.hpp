@@ -0,0 +1,107 @@
+/*
+** Agartha-Software, 2024
+** C++evy
+** File description:
+** Dynamic tree broadphase
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+#include "AABB.hpp"
+#include "BoxBatch.hpp"
+#include "Broadphase.hpp"
+#include "DynamicTree.hpp"
+
+namespace cevy::physics {
+/**
+ * @brief Broadphase storing colliders in two DynamicTree, one for the static ones
+ *
+ * Colliders are inserted in the dynamic tree. Those which keep the same box for
+ * settle_frames updates move to the static tree, and back on their first move.
+ * The pairs of two static colliders are kept from one frame to the next, so only the
+ * moving colliders are tested: against each other and against the static tree.
+ * Unlike the SpatialHash, colliders of any size cost the same, a huge static level
+ * collider is a single leaf.
+ */
+class TreeBroadphase final : public Broadphase {
+  public:
+  /// Closest collider hit by a ray
+  struct RayHit {
+    size_t id;
+    /// in lengths of the ray direction
+    float distance;
+  };
+
+  /// margin: added on every side of the boxes, so that small moves don't update the tree
+  TreeBroadphase(float margin = 1, size_t settle_frames = 60);
+
+  void update(size_t id, const engine::AABB &box) override;
+  void remove(size_t id) override;
+  void sweep() override;
+  void clear() override;
+
+  bool contains(size_t id) const override {
+    return id < _proxies.size() && _proxies[id].active;
+  }
+
+  size_t size() const override { return _count; }
+
+  /// Whether the collider is in the static tree
+  bool is_static(size_t id) const { return contains(id) && _proxies[id].is_static; }
+
+  void pairs(std::vector<Pair> &out) override;
+
+  /// Every collider whose box overlaps box, sorted
+  void query(const engine::AABB &box, std::vector<size_t> &out) const;
+
+  /**
+   * @brief Closest collider whose box is hit by the ray, within max_distance
+   *
+   * A ray starting inside a box hits it at distance 0.
+   * Returns false when nothing is hit.
+   */
+  bool raycast(const engine::Vector &origin, const engine::Vector &direction, float max_distance,
+               RayHit &hit) const;
+
+  const DynamicTree &static_tree() const { return _static; }
+  const DynamicTree &dynamic_tree() const { return _dynamic; }
+
+  protected:
+  struct Proxy {
+    engine::AABB box;
+    int32_t node = DynamicTree::null_node;
+    /// updates without moving
+    size_t still = 0;
+    size_t epoch = 0;
+    bool is_static = false;
+    bool active = false;
+  };
+
+  static uint64_t key(size_t a, size_t b) {
+    return a < b ? uint64_t(a) << 32 | b : uint64_t(b) << 32 | a;
+  }
+
+  /// Move the collider to the static tree, finding its static pairs
+  void settle(size_t id);
+  /// Move the collider out of the static tree, forgetting its static pairs
+  void wake(size_t id);
+
+  DynamicTree _static;
+  DynamicTree _dynamic;
+  size_t _settle_frames;
+
+  /// indexed by collider id
+  std::vector<Proxy> _proxies;
+  BoxArrays _boxes;
+  size_t _count = 0;
+  size_t _epoch = 0;
+
+  /// overlapping static colliders, the min id in the high 32 bits
+  std::unordered_set<uint64_t> _static_pairs;
+};
+} // namespace cevy::physics
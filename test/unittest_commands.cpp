@@ -0,0 +1,326 @@
+#include <criterion/criterion.h>
+
+#include "App.hpp"
+#include "CommandBuffer.hpp"
+#include "Commands.hpp"
+#include "DefaultPlugin.hpp"
+#include "EntityCommands.hpp"
+#include "TaskPool.hpp"
+#include "World.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace cevy::ecs;
+
+struct Name {
+  std::string value;
+};
+
+struct Health {
+  int value = 0;
+};
+
+template <typename T>
+static bool has(World &world, size_t e) {
+  auto &components = world.get_components<T>();
+  return e < components.size() && components[e];
+}
+
+Test(CommandBuffer, insert_and_remove) {
+  World world;
+  CommandBuffer buffer;
+  world.init_component<Name>();
+  world.init_component<Health>();
+  auto e = world.spawn_empty().id();
+
+  buffer.insert(e, Name {"a rather long name that does not fit in small strings"});
+  buffer.insert(e, Health {10});
+  buffer.remove<Health>(e);
+  cr_assert(buffer.size() == 3);
+  cr_assert(!has<Name>(world, e));
+  buffer.apply(world);
+  cr_assert(buffer.empty());
+  cr_assert(world.get_components<Name>()[e]->value ==
+            "a rather long name that does not fit in small strings");
+  cr_assert(!has<Health>(world, e));
+}
+
+Test(CommandBuffer, keeps_order_and_pages) {
+  World world;
+  CommandBuffer buffer(256);
+  std::vector<int> order;
+
+  for (int i = 0; i < 100; ++i) {
+    buffer.custom([&order, i](World &) { order.push_back(i); });
+  }
+  size_t capacity = buffer.capacity();
+  cr_assert(capacity > 256);
+  buffer.apply(world);
+  cr_assert(order.size() == 100);
+  for (int i = 0; i < 100; ++i) {
+    cr_assert(order[i] == i);
+  }
+  buffer.custom([&order](World &) { order.push_back(100); });
+  cr_assert(buffer.capacity() == capacity);
+}
+
+Test(CommandBuffer, push_while_applying) {
+  World world;
+  CommandBuffer buffer(128);
+  std::vector<int> order;
+
+  buffer.custom([&](World &) {
+    order.push_back(0);
+    for (int i = 1; i < 20; ++i) {
+      buffer.custom([&order, i](World &) { order.push_back(i); });
+    }
+  });
+  buffer.apply(world);
+  cr_assert(order.size() == 20);
+  for (int i = 0; i < 20; ++i) {
+    cr_assert(order[i] == i);
+  }
+  cr_assert(buffer.empty());
+}
+
+Test(CommandBuffer, clear_destroys_payloads) {
+  World world;
+  auto shared = std::make_shared<int>(0);
+
+  {
+    CommandBuffer buffer;
+    buffer.custom([shared](World &) { *shared += 1; });
+    buffer.custom([shared](World &) { *shared += 1; });
+    cr_assert(shared.use_count() == 3);
+    buffer.clear();
+    cr_assert(shared.use_count() == 1);
+    buffer.custom([shared](World &) { *shared += 1; });
+  }
+  cr_assert(shared.use_count() == 1);
+  cr_assert(*shared == 0);
+}
+
+Test(CommandBuffer, grouped_by_type_keeps_order) {
+  World world;
+  CommandBuffer buffer;
+  world.init_component<Name>();
+  world.init_component<Health>();
+  std::vector<size_t> e;
+  for (size_t i = 0; i < 4; ++i) {
+    e.push_back(world.spawn_empty().id());
+  }
+
+  buffer.insert(e[0], Health {1});
+  buffer.insert(e[0], Name {"zero"});
+  buffer.remove<Health>(e[0]);
+  buffer.insert(e[1], Health {2});
+  buffer.insert(e[1], Health {3});
+  buffer.custom([&](World &w) { cr_assert(w.get_components<Health>()[e[1]]->value == 3); });
+  buffer.insert(e[2], Health {4});
+  buffer.despawn(e[2]);
+  buffer.despawn(e[3]);
+  buffer.insert(e[3], Name {"three"});
+  buffer.apply(world);
+
+  cr_assert(!has<Health>(world, e[0]));
+  cr_assert(world.get_components<Name>()[e[0]]->value == "zero");
+  cr_assert(world.get_components<Health>()[e[1]]->value == 3);
+  cr_assert(!has<Health>(world, e[2]));
+  cr_assert(!world.entities()[e[2]] && !world.entities()[e[3]]);
+  /* despawned entities do not get components back */
+  cr_assert(!has<Name>(world, e[3]));
+}
+
+Test(World, reuse_despawned_ids) {
+  World world;
+  CommandBuffer buffer;
+  world.init_component<Health>();
+  for (size_t i = 0; i < 6; ++i) {
+    world.spawn(Health {int(i)});
+  }
+
+  buffer.despawn(1);
+  buffer.despawn(4);
+  buffer.despawn(4);
+  buffer.apply(world);
+  size_t a = world.reserve_entity();
+  size_t b = world.reserve_entity();
+  size_t c = world.reserve_entity();
+  cr_assert((a == 4 && b == 1) || (a == 1 && b == 4));
+  cr_assert(c == 6);
+  buffer.insert(a, Health {10});
+  buffer.insert(c, Health {12});
+  world.flush_reserved_entities();
+  buffer.apply(world);
+
+  cr_assert(world.entities().size() == 7);
+  cr_assert(world.entities()[1] && world.entities()[4] && world.entities()[6]);
+  cr_assert(world.get_components<Health>()[a]->value == 10);
+  cr_assert(!has<Health>(world, b));
+  cr_assert(size_t(world.spawn_empty().id()) == 7);
+}
+
+struct Heavy {
+  std::shared_ptr<int> resource;
+};
+
+template <>
+struct cevy::ecs::deferred_drop<Heavy> : std::true_type {};
+
+Test(World, deferred_drop) {
+  World world;
+  CommandBuffer buffer;
+  world.init_component<Heavy>();
+  auto resource = std::make_shared<int>(0);
+  auto e = world.spawn(Heavy {resource}).id();
+
+  buffer.despawn(e);
+  buffer.apply(world);
+  cr_assert(!has<Heavy>(world, e));
+  cr_assert(world.deferred_drops() == 1);
+  cr_assert(resource.use_count() == 2);
+  world.drop_deferred();
+  cr_assert(resource.use_count() == 1);
+}
+
+struct Tracked {
+  int value = 0;
+};
+
+template <>
+struct cevy::ecs::track_removals<Tracked> : std::true_type {};
+
+Test(World, track_removals) {
+  World world;
+  CommandBuffer buffer;
+  world.init_component<Tracked>();
+  world.init_resource<RemovedComponents<Tracked>>();
+  auto a = world.spawn(Tracked {1}).id();
+  auto b = world.spawn(Tracked {2}).id();
+  auto c = world.spawn(Tracked {3}).id();
+  auto &removed = world.resource<RemovedComponents<Tracked>>().entities;
+
+  /* replacing is not removing */
+  buffer.insert(a, Tracked {4});
+  buffer.remove<Tracked>(b);
+  buffer.apply(world);
+  cr_assert_eq(removed.size(), 1);
+  cr_assert_eq(size_t(removed[0]), size_t(b));
+
+  world.despawn(a);
+  world.despawn_many({size_t(b), size_t(c)});
+  cr_assert_eq(removed.size(), 3);
+  cr_assert_eq(size_t(removed[1]), size_t(a));
+  cr_assert_eq(size_t(removed[2]), size_t(c));
+}
+
+Test(CommandBuffer, large_flush) {
+  World world;
+  CommandBuffer buffer;
+  world.init_component<Name>();
+  world.init_component<Health>();
+
+  for (size_t i = 0; i < 20000; ++i) {
+    size_t e = world.reserve_entity();
+    buffer.insert(e, Health {int(i)});
+    buffer.insert(e, Name {"entity"});
+  }
+  world.flush_reserved_entities();
+  buffer.apply(world);
+  for (size_t i = 0; i < 20000; i += 2) {
+    buffer.despawn(i);
+  }
+  buffer.apply(world);
+
+  auto &health = world.get_components<Health>();
+  auto &names = world.get_components<Name>();
+  cr_assert(health.size() == 20000);
+  for (size_t i = 0; i < 20000; ++i) {
+    cr_assert(bool(health[i]) == (i % 2 == 1) && bool(names[i]) == (i % 2 == 1));
+    cr_assert(!health[i] || health[i]->value == int(i));
+  }
+}
+
+template <typename Q>
+static size_t count(Q &query) {
+  size_t n = 0;
+
+  for (auto it = query.begin(); it != query.end(); ++it) {
+    n += 1;
+  }
+  return n;
+}
+
+struct Seen {
+  size_t during_startup = 0;
+  size_t after_startup = 0;
+  size_t healthy = 0;
+};
+
+static void spawn_named(Commands commands, Query<Name> names, Resource<Seen> seen) {
+  auto e = commands.spawn(Name {"deferred"}, Health {3}).id();
+  commands.entity(e).remove<Health>();
+  commands.add([](World &w) { w.spawn(Health {7}); });
+  seen->during_startup = count(names);
+}
+
+/// commands are applied at the end of the stage
+static void look(Query<Name> names, Query<Health> healthy, Resource<Seen> seen,
+                 EventWriter<AppExit> exit) {
+  seen->after_startup = count(names);
+  seen->healthy = count(healthy);
+  exit.send(AppExit {});
+}
+
+Test(Commands, spawn_is_deferred) {
+  App app;
+  app.add_plugins(DefaultPlugin());
+  app.init_component<Name>();
+  app.init_component<Health>();
+  app.init_resource<Seen>();
+  app.add_systems<core_stage::Startup>(spawn_named);
+  app.add_systems<core_stage::Update>(look);
+  app.run();
+  cr_assert(app.resource<Seen>().during_startup == 0);
+  cr_assert(app.resource<Seen>().after_startup == 1);
+  cr_assert(app.resource<Seen>().healthy == 1);
+}
+
+struct Log {
+  std::vector<size_t> order;
+};
+
+template <size_t N>
+static void spawn_many(Commands commands) {
+  for (size_t i = 0; i < 50; ++i) {
+    commands.spawn(Health {int(N)});
+  }
+  commands.add([](World &w) { w.resource<Log>().order.push_back(N); });
+}
+
+static void stop(EventWriter<AppExit> exit) { exit.send(AppExit {}); }
+
+Test(Commands, merged_in_registration_order) {
+  App app;
+  app.add_plugins(DefaultPlugin());
+  app.init_component<Health>();
+  app.init_resource<Log>();
+  app.init_resource<TaskPool>(4);
+  app.add_systems<core_stage::Update>(spawn_many<3>, spawn_many<1>, spawn_many<2>,
+                                      spawn_many<0>);
+  app.add_systems<core_stage::Update>(stop);
+  app.run();
+
+  const auto &order = app.resource<Log>().order;
+  cr_assert(order.size() == 4);
+  cr_assert(order[0] == 3 && order[1] == 1 && order[2] == 2 && order[3] == 0);
+
+  auto &entities = app.entities();
+  auto &health = app.get_components<Health>();
+  cr_assert(entities.size() == 200);
+  for (size_t e = 0; e < entities.size(); ++e) {
+    cr_assert(entities[e] && health[e]);
+  }
+}
@@ -0,0 +1,117 @@
+#include <criterion/criterion.h>
+
+#include "DrawMatrices.hpp"
+
+#include <cmath>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+using cevy::engine::DrawMatrices;
+
+static glm::mat4 make_matrix(float seed) {
+  glm::vec3 position(seed, -2 * seed, 0.5f);
+  glm::quat rotation(glm::vec3(0.3f * seed, 1.1f, -0.7f * seed));
+  glm::vec3 scale(1 + 0.1f * seed, 2, 0.5f + 0.05f * seed);
+
+  return glm::translate(glm::mat4(1), position) * glm::mat4(rotation) *
+         glm::scale(glm::mat4(1), scale);
+}
+
+/* compares the draws that have a finite inverse, the others only where glm is finite */
+static void assert_matches_scalar(const DrawMatrices &matrices,
+                                  const std::vector<glm::mat4> &worlds,
+                                  const std::vector<glm::mat4> &locals) {
+  cr_assert_eq(matrices.size(), worlds.size());
+  for (size_t i = 0; i < worlds.size(); ++i) {
+    glm::mat4 model = worlds[i] * locals[i];
+    glm::mat3 normal = glm::inverse(glm::mat3(locals[i])) * glm::inverse(glm::mat3(worlds[i]));
+
+    for (int c = 0; c < 4; ++c) {
+      for (int r = 0; r < 4; ++r) {
+        if (std::isfinite(model[c][r])) {
+          cr_assert_float_eq(matrices.model(i)[c][r], model[c][r], 1e-3);
+        }
+      }
+    }
+    for (int c = 0; c < 3; ++c) {
+      for (int r = 0; r < 3; ++r) {
+        if (std::isfinite(normal[c][r])) {
+          cr_assert_float_eq(matrices.normal(i)[c][r], normal[c][r], 1e-3);
+        }
+      }
+    }
+  }
+}
+
+Test(DrawMatrices, batches_match_scalar) {
+  DrawMatrices matrices;
+  std::vector<glm::mat4> worlds;
+  std::vector<glm::mat4> locals;
+
+  /* two full batches and a partial one */
+  for (size_t i = 0; i < 2 * DrawMatrices::lanes + 5; ++i) {
+    worlds.push_back(make_matrix(float(i)));
+    locals.push_back(make_matrix(float(i) * 0.5f + 3));
+    matrices.push(worlds.back(), locals.back(), glm::inverse(glm::mat3(locals.back())));
+  }
+  matrices.compute();
+  assert_matches_scalar(matrices, worlds, locals);
+
+  matrices.clear();
+  matrices.compute();
+  cr_assert_eq(matrices.size(), 0);
+}
+
+/* from no draw to just past two batches, each count reusing the matrices of the previous one */
+Test(DrawMatrices, every_partial_batch) {
+  DrawMatrices matrices;
+
+  for (size_t count = 0; count <= 2 * DrawMatrices::lanes + 1; ++count) {
+    std::vector<glm::mat4> worlds;
+    std::vector<glm::mat4> locals;
+
+    matrices.clear();
+    for (size_t i = 0; i < count; ++i) {
+      worlds.push_back(make_matrix(float(i + count)));
+      locals.push_back(make_matrix(float(i) * 0.25f - 1));
+      matrices.push(worlds.back(), locals.back(), glm::inverse(glm::mat3(locals.back())));
+    }
+    matrices.compute();
+    assert_matches_scalar(matrices, worlds, locals);
+  }
+}
+
+/* a flattened or broken draw must not leak into the other lanes of its batch */
+Test(DrawMatrices, degenerate_lanes) {
+  DrawMatrices matrices;
+  std::vector<glm::mat4> worlds;
+  std::vector<glm::mat4> locals;
+  float nan = std::nanf("");
+
+  for (size_t i = 0; i < DrawMatrices::lanes + 3; ++i) {
+    worlds.push_back(make_matrix(float(i)));
+    locals.push_back(make_matrix(2));
+  }
+  worlds[1] = glm::scale(worlds[1], glm::vec3(0, 0, 0));
+  worlds[2] = glm::scale(worlds[2], glm::vec3(1, 0, 1));
+  worlds[4][3] = glm::vec4(nan, 0, nan, 1);
+  worlds[6][0][0] = nan;
+  for (size_t i = 0; i < worlds.size(); ++i) {
+    matrices.push(worlds[i], locals[i], glm::inverse(glm::mat3(locals[i])));
+  }
+  matrices.compute();
+  assert_matches_scalar(matrices, worlds, locals);
+
+  /* a NaN translation leaves the normal matrix alone */
+  cr_assert(std::isnan(matrices.model(4)[3][0]));
+  for (int c = 0; c < 3; ++c) {
+    cr_assert(std::isfinite(matrices.normal(4)[c][0]));
+  }
+  for (size_t i : {0, 3, 5, 7, 8}) {
+    for (int c = 0; c < 4; ++c) {
+      for (int r = 0; r < 4; ++r) {
+        cr_assert(std::isfinite(matrices.model(i)[c][r]));
+      }
+    }
+  }
+}
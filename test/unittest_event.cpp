@@ -0,0 +1,147 @@
+#include <criterion/criterion.h>
+
+#include "App.hpp"
+#include "DefaultPlugin.hpp"
+#include "Event.hpp"
+
+#include <thread>
+#include <vector>
+
+using namespace cevy::ecs;
+
+struct Ping {
+  size_t frame;
+};
+
+struct Received {
+  size_t frames = 0;
+  std::vector<size_t> early;
+  std::vector<size_t> late;
+};
+
+Test(Event, double_buffer) {
+  Event<int> events;
+
+  events.send(1);
+  events.send(2);
+  cr_assert(events.size() == 2);
+  events.update();
+  events.send(3);
+  cr_assert(events.size() == 3);
+  cr_assert(events.first_id() == 0 && events.next_id() == 3);
+  events.update();
+  cr_assert(events.size() == 1);
+  cr_assert(events.first_id() == 2 && events.at(2) == 3);
+  events.update();
+  cr_assert(events.empty());
+  cr_assert(events.first_id() == 3 && events.next_id() == 3);
+}
+
+static void send_pings(Resource<Received> received, EventWriter<Ping> pings,
+                       EventWriter<AppExit> exit) {
+  received->frames += 1;
+  for (size_t i = 0; i < 100; ++i) {
+    pings.send(Ping {received->frames});
+  }
+  if (received->frames == 5) {
+    exit.send(AppExit {});
+  }
+}
+
+static void read_early(EventReader<Ping> pings, Resource<Received> received) {
+  received->early.push_back(pings.size());
+}
+
+static void read_late(EventReader<Ping> pings, Resource<Received> received) {
+  size_t count = 0;
+
+  for (const auto &ping : pings) {
+    cr_assert(ping.frame == received->frames);
+    count += 1;
+  }
+  received->late.push_back(count);
+}
+
+Test(Event, each_reader_reads_once) {
+  App app;
+  app.add_plugins(DefaultPlugin());
+  app.add_event<Ping>();
+  app.init_resource<Received>();
+  /* the early reader runs before the writer, it gets the events of the previous frame */
+  app.add_systems<core_stage::PreUpdate>(read_early);
+  app.add_systems<core_stage::Update>(send_pings);
+  app.add_systems<core_stage::PostUpdate>(read_late);
+  app.run();
+
+  const auto &received = app.resource<Received>();
+  cr_assert(received.early.size() == 5 && received.late.size() == 5);
+  cr_assert(received.early[0] == 0);
+  for (size_t i = 1; i < 5; ++i) {
+    cr_assert(received.early[i] == 100);
+  }
+  for (size_t i = 0; i < 5; ++i) {
+    cr_assert(received.late[i] == 100);
+  }
+}
+
+Test(Event, channel_full) {
+  EventChannel<int> channel(3);
+  int value;
+
+  cr_assert(channel.capacity() == 4);
+  for (int i = 0; i < 4; ++i) {
+    cr_assert(channel.push(i));
+  }
+  cr_assert(!channel.push(4));
+  cr_assert(channel.dropped() == 1);
+  cr_assert(channel.pop(value) && value == 0);
+  cr_assert(channel.push(5));
+  for (int expected : {1, 2, 3, 5}) {
+    cr_assert(channel.pop(value) && value == expected);
+  }
+  cr_assert(!channel.pop(value));
+}
+
+struct Injected {
+  size_t thread;
+  size_t index;
+};
+
+static constexpr size_t threads = 4;
+static constexpr size_t per_thread = 1000;
+
+static void read_injected(EventReader<Injected> injected, Resource<Received> received,
+                          EventWriter<AppExit> exit) {
+  std::vector<size_t> next(threads, 0);
+
+  for (const auto &event : injected) {
+    /* the order of each producer is kept */
+    cr_assert(event.index == next[event.thread]);
+    next[event.thread] += 1;
+  }
+  received->late.push_back(injected.size());
+  exit.send(AppExit {});
+}
+
+Test(Event, sender_from_threads) {
+  App app;
+  app.add_plugins(DefaultPlugin());
+  auto sender = app.event_sender<Injected>(threads * per_thread);
+  std::vector<std::thread> producers;
+
+  for (size_t t = 0; t < threads; ++t) {
+    producers.emplace_back([sender, t]() mutable {
+      for (size_t i = 0; i < per_thread; ++i) {
+        cr_assert(sender.send(Injected {t, i}));
+      }
+    });
+  }
+  for (auto &producer : producers) {
+    producer.join();
+  }
+  app.init_resource<Received>();
+  app.add_systems<core_stage::Update>(read_injected);
+  app.run();
+  const auto &received = app.resource<Received>();
+  cr_assert(received.late.size() == 1 && received.late[0] == threads * per_thread);
+}
@@ -0,0 +1,135 @@
+#include <criterion/criterion.h>
+
+#include "App.hpp"
+#include "DefaultPlugin.hpp"
+#include "Hierarchy.hpp"
+
+#include <vector>
+
+using namespace cevy::ecs;
+using cevy::engine::Children;
+using cevy::engine::GlobalTransform;
+using cevy::engine::Hierarchy;
+using cevy::engine::Parent;
+using cevy::engine::Transform;
+
+struct Frames {
+  size_t count = 0;
+};
+
+static void exit_after_one(Resource<Frames> frames, EventWriter<AppExit> exit) {
+  frames->count += 1;
+  exit.send(AppExit {});
+}
+
+static App make_app() {
+  App app;
+  app.add_plugins(DefaultPlugin());
+  app.init_component<Transform>();
+  app.init_component<Parent>();
+  app.init_component<Children>();
+  app.init_component<GlobalTransform>();
+  app.init_resource<Frames>();
+  app.add_systems<core_stage::PreUpdate>(Hierarchy::sync_children, Hierarchy::propagate).chain();
+  app.add_systems<core_stage::Update>(exit_after_one);
+  return app;
+}
+
+static float world_x(App &app, Entity e) {
+  return app.get_components<Transform>()[e]->get_world().position.x;
+}
+
+Test(Hierarchy, deep_chain) {
+  App app = make_app();
+  std::vector<Entity> chain;
+
+  /* children are spawned before their parent, in reverse order */
+  for (size_t i = 0; i < 200; ++i) {
+    chain.push_back(app.spawn(Transform(1, 0, 0)));
+  }
+  for (size_t i = 0; i + 1 < chain.size(); ++i) {
+    app.get_components<Parent>().insert_at(chain[i], Parent {chain[i + 1]});
+  }
+  app.run();
+
+  for (size_t i = 0; i < chain.size(); ++i) {
+    cr_assert_float_eq(world_x(app, chain[i]), float(chain.size() - i), 1e-3);
+  }
+  auto &children = app.get_components<Children>();
+  cr_assert(children[chain[1]].has_value());
+  cr_assert(children[chain[1]]->entities.size() == 1);
+  cr_assert(children[chain[1]]->entities[0] == chain[0]);
+  cr_assert(!children[chain[0]].has_value());
+}
+
+Test(Hierarchy, siblings_orphans_and_cycles) {
+  App app = make_app();
+  Entity root = app.spawn(Transform(0, 10, 0));
+  Entity a = app.spawn(Transform(1, 0, 0), Parent {root});
+  Entity b = app.spawn(Transform(2, 0, 0), Parent {root});
+  Entity untransformed = app.spawn_empty().id();
+  Entity orphan = app.spawn(Transform(3, 0, 0), Parent {untransformed});
+  Entity loop_a = app.spawn(Transform(4, 0, 0));
+  Entity loop_b = app.spawn(Transform(5, 0, 0), Parent {loop_a});
+  app.get_components<Parent>().insert_at(loop_a, Parent {loop_b});
+  app.run();
+
+  auto &transforms = app.get_components<Transform>();
+  cr_assert_float_eq(transforms[a]->get_world().position.y, 10, 1e-3);
+  cr_assert_float_eq(world_x(app, b), 2, 1e-3);
+  cr_assert_float_eq(world_x(app, orphan), 3, 1e-3);
+  auto &children = app.get_components<Children>();
+  cr_assert(children[root]->entities.size() == 2);
+  cr_assert(children[root]->entities[0] == a && children[root]->entities[1] == b);
+  /* a cycle has no root, it is left as is */
+  cr_assert(children[loop_a].has_value() && children[loop_b].has_value());
+}
+
+struct Moved {
+  Entity root;
+  Entity leaf;
+  Entity other;
+};
+
+static void move_on_second_frame(Resource<Frames> frames, Resource<Moved> moved,
+                                 Query<Transform> transforms, Query<Parent> parents,
+                                 EventWriter<AppExit> exit) {
+  frames->count += 1;
+  if (frames->count == 2) {
+    std::get<0>(*transforms.from(moved->root)).translateX(5);
+    std::get<0>(*parents.from(moved->leaf)).entity = moved->other;
+  }
+  if (frames->count == 3) {
+    exit.send(AppExit {});
+  }
+}
+
+Test(Hierarchy, global_transform_follows_changes) {
+  App app;
+  app.add_plugins(DefaultPlugin());
+  app.init_component<Transform>();
+  app.init_component<Parent>();
+  app.init_component<Children>();
+  app.init_component<GlobalTransform>();
+  app.init_resource<Frames>();
+  app.add_systems<core_stage::PreUpdate>(Hierarchy::sync_children, Hierarchy::propagate).chain();
+  app.add_systems<core_stage::Update>(move_on_second_frame);
+
+  Entity root = app.spawn(Transform(1, 0, 0));
+  Entity mid = app.spawn(Transform(1, 0, 0), Parent {root});
+  Entity leaf = app.spawn(Transform(1, 0, 0), Parent {mid});
+  Entity other = app.spawn(Transform(0, 7, 0));
+  Entity still = app.spawn(Transform(0, 0, 3), Parent {other});
+  app.init_resource<Moved>(Moved {root, leaf, other});
+  app.run();
+
+  auto &globals = app.get_components<GlobalTransform>();
+  cr_assert_float_eq(globals[root]->position().x, 6, 1e-3);
+  cr_assert_float_eq(globals[mid]->position().x, 7, 1e-3);
+  /* the leaf moved under other */
+  cr_assert_float_eq(globals[leaf]->position().x, 1, 1e-3);
+  cr_assert_float_eq(globals[leaf]->position().y, 7, 1e-3);
+  cr_assert_float_eq(globals[still]->position().z, 3, 1e-3);
+  cr_assert_float_eq(globals[mid]->mat4()[3][0], 7, 1e-3);
+  cr_assert_float_eq(world_x(app, leaf), 1, 1e-3);
+}
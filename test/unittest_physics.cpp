@@ -0,0 +1,668 @@
+#include <criterion/criterion.h>
+
+#include "App.hpp"
+#include "BoxBatch.hpp"
+#include "Collider.hpp"
+#include "ContactCache.hpp"
+#include "DefaultPlugin.hpp"
+#include "DynamicTree.hpp"
+#include "GlobalTransform.hpp"
+#include "Physics.hpp"
+#include "SpatialHash.hpp"
+#include "SweepAndPrune.hpp"
+#include "TaskPool.hpp"
+#include "Transform.hpp"
+#include "TreeBroadphase.hpp"
+
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+using namespace cevy::ecs;
+using cevy::engine::AABB;
+using cevy::engine::GlobalTransform;
+using cevy::engine::Transform;
+using cevy::engine::Vector;
+using cevy::physics::BoxArrays;
+using cevy::physics::Broadphase;
+using cevy::physics::BroadphaseKind;
+using cevy::physics::BroadphasePairs;
+using cevy::physics::Collider;
+using cevy::physics::CollisionEnded;
+using cevy::physics::CollisionStarted;
+using cevy::physics::ContactCache;
+using cevy::physics::DynamicTree;
+using cevy::physics::PhysicsPlugin;
+using cevy::physics::Shape;
+using cevy::physics::SpatialHash;
+using cevy::physics::SweepAndPrune;
+using cevy::physics::TreeBroadphase;
+namespace batch = cevy::physics::batch;
+
+static std::vector<AABB> make_boxes(size_t count, float offset) {
+  std::vector<AABB> boxes;
+
+  for (size_t i = 0; i < count; ++i) {
+    float f = float(i) + offset;
+    /* around the origin, some spanning several cells */
+    Vector min(std::sin(f * 1.3f) * 40, std::cos(f * 0.7f) * 40, std::sin(f * 0.4f) * 10);
+    Vector size(1 + (i % 5) * 3, 1 + (i % 3) * 5, 2);
+
+    boxes.emplace_back(min, min + size);
+  }
+  return boxes;
+}
+
+static std::vector<SpatialHash::Pair> brute_force(const std::vector<AABB> &boxes) {
+  std::vector<SpatialHash::Pair> pairs;
+
+  for (size_t a = 0; a < boxes.size(); ++a) {
+    for (size_t b = a + 1; b < boxes.size(); ++b) {
+      if (boxes[a].intersects(boxes[b])) {
+        pairs.emplace_back(a, b);
+      }
+    }
+  }
+  return pairs;
+}
+
+/* moving boxes, some of them removed and added back */
+static void match_brute_force(Broadphase &broadphase) {
+  std::vector<SpatialHash::Pair> pairs;
+
+  for (float offset = 0; offset < 3; offset += 0.05f) {
+    std::vector<AABB> boxes = make_boxes(150, offset);
+    std::vector<AABB> present;
+    std::vector<size_t> ids;
+
+    for (size_t i = 0; i < boxes.size(); ++i) {
+      if ((i + size_t(offset * 20)) % 7 == 0) {
+        continue;
+      }
+      broadphase.update(i, boxes[i]);
+      ids.push_back(i);
+      present.push_back(boxes[i]);
+    }
+    broadphase.sweep();
+    broadphase.pairs(pairs);
+    cr_assert_eq(broadphase.size(), present.size());
+
+    auto expected = brute_force(present);
+    for (auto &[a, b] : expected) {
+      a = ids[a];
+      b = ids[b];
+    }
+    cr_assert(pairs == expected);
+  }
+}
+
+Test(SpatialHash, pairs_match_brute_force) {
+  SpatialHash hash(8);
+
+  match_brute_force(hash);
+}
+
+Test(SweepAndPrune, pairs_match_brute_force) {
+  SweepAndPrune sap;
+
+  match_brute_force(sap);
+}
+
+Test(TreeBroadphase, pairs_match_brute_force) {
+  TreeBroadphase tree(0.5f, 2);
+
+  match_brute_force(tree);
+}
+
+Test(TreeBroadphase, static_and_dynamic) {
+  TreeBroadphase tree(0.5f, 3);
+  std::vector<SpatialHash::Pair> pairs;
+  std::vector<AABB> boxes = make_boxes(200, 0);
+
+  /* the even boxes don't move, they end up in the static tree */
+  for (float offset = 0; offset < 1; offset += 0.05f) {
+    std::vector<AABB> moved = make_boxes(200, offset);
+
+    for (size_t i = 1; i < boxes.size(); i += 2) {
+      boxes[i] = moved[i];
+    }
+    for (size_t i = 0; i < boxes.size(); ++i) {
+      tree.update(i, boxes[i]);
+    }
+    tree.sweep();
+    tree.pairs(pairs);
+    cr_assert(pairs == brute_force(boxes));
+    cr_assert(tree.static_tree().validate());
+    cr_assert(tree.dynamic_tree().validate());
+  }
+  cr_assert_eq(tree.static_tree().size(), 100);
+  cr_assert(tree.is_static(0));
+  cr_assert(!tree.is_static(1));
+
+  boxes[0] = AABB(Vector(-1, -1, -1), Vector(1, 1, 1));
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    tree.update(i, boxes[i]);
+  }
+  tree.pairs(pairs);
+  cr_assert(!tree.is_static(0));
+  cr_assert(pairs == brute_force(boxes));
+
+  tree.remove(2);
+  boxes[2] = AABB(Vector(1000, 1000, 1000), Vector(1000, 1000, 1000));
+  tree.pairs(pairs);
+  cr_assert(pairs == brute_force(boxes));
+  cr_assert_eq(tree.size(), 199);
+}
+
+Test(TreeBroadphase, query_and_raycast) {
+  TreeBroadphase tree(0.5f, 1);
+  std::vector<AABB> boxes = make_boxes(300, 0);
+  std::vector<size_t> found;
+
+  for (size_t frame = 0; frame < 3; ++frame) {
+    for (size_t i = 0; i < boxes.size(); ++i) {
+      tree.update(i, boxes[i]);
+    }
+  }
+  for (const AABB &area : make_boxes(20, 0.5f)) {
+    std::vector<size_t> expected;
+
+    for (size_t i = 0; i < boxes.size(); ++i) {
+      if (area.intersects(boxes[i])) {
+        expected.push_back(i);
+      }
+    }
+    tree.query(area, found);
+    cr_assert(found == expected);
+  }
+
+  for (float angle = 0; angle < 6.28f; angle += 0.1f) {
+    Vector origin(-60, std::sin(angle) * 30, 1);
+    Vector direction = Vector(std::cos(angle), std::sin(angle * 3), 0.1f).normalize();
+    Vector inverse(1 / direction.x, 1 / direction.y, 1 / direction.z);
+    float closest = std::numeric_limits<float>::infinity();
+    float distance;
+    TreeBroadphase::RayHit hit;
+
+    for (const AABB &box : boxes) {
+      if (box.raycast(origin, inverse, 200, distance)) {
+        closest = std::min(closest, distance);
+      }
+    }
+    bool found_hit = tree.raycast(origin, direction, 200, hit);
+    cr_assert_eq(found_hit, closest != std::numeric_limits<float>::infinity());
+    if (found_hit) {
+      cr_assert_float_eq(hit.distance, closest, 1e-5);
+      cr_assert(boxes[hit.id].raycast(origin, inverse, 200, distance));
+    }
+  }
+}
+
+Test(DynamicTree, stays_balanced) {
+  DynamicTree tree(0.1f);
+  std::vector<int32_t> proxies;
+
+  /* sorted insertions, the worst case without rotations */
+  for (size_t i = 0; i < 1024; ++i) {
+    Vector min(float(i), 0, 0);
+
+    proxies.push_back(tree.create(i, AABB(min, min + Vector(1, 1, 1))));
+  }
+  cr_assert(tree.validate());
+  cr_assert_lt(tree.height(), 20);
+
+  for (size_t i = 0; i < proxies.size(); ++i) {
+    Vector min(float(i) + (i % 2 ? 0.05f : 500), 0, 0);
+
+    tree.move(proxies[i], AABB(min, min + Vector(1, 1, 1)));
+  }
+  for (size_t i = 0; i < proxies.size(); i += 2) {
+    tree.destroy(proxies[i]);
+  }
+  cr_assert(tree.validate());
+  cr_assert_eq(tree.size(), 512);
+  cr_assert_lt(tree.height(), 20);
+
+  size_t count = 0;
+  tree.query(AABB(Vector(-1, -1, -1), Vector(2000, 2, 2)), [&](int32_t) {
+    count += 1;
+    return true;
+  });
+  cr_assert_eq(count, 512);
+  tree.clear();
+  cr_assert_eq(tree.size(), 0);
+  cr_assert(tree.validate());
+}
+
+/* a proxy moving a bit past its fat box every frame, across the whole grid */
+Test(DynamicTree, long_move_keeps_surface) {
+  DynamicTree moved(0.5f);
+  DynamicTree built(0.5f);
+  int32_t proxy = DynamicTree::null_node;
+
+  for (size_t i = 0; i < 400; ++i) {
+    Vector min(float(i % 20) * 10, float(i / 20) * 10, 0);
+    AABB box(min, min + Vector(1, 1, 1));
+
+    if (i == 0) {
+      proxy = moved.create(i, box);
+    } else {
+      moved.create(i, box);
+      built.create(i, box);
+    }
+  }
+  for (size_t step = 1; step <= 400; ++step) {
+    Vector min(float(step) * 0.6f, float(step) * 0.45f, 0);
+
+    moved.move(proxy, AABB(min, min + Vector(1, 1, 1)));
+  }
+  Vector end(400 * 0.6f, 400 * 0.45f, 0);
+  built.create(0, AABB(end, end + Vector(1, 1, 1)));
+  cr_assert(moved.validate());
+
+  /* the ancestors of the proxy do not stretch along its path, refitting them in place
+     costs about a third more than building the tree with the proxy at its end */
+  cr_assert_lt(moved.area_ratio(), built.area_ratio() * 1.2f);
+
+  size_t found = 0;
+  moved.query(AABB(Vector(42, 42, 0), Vector(48, 48, 1)), [&](int32_t) {
+    found += 1;
+    return true;
+  });
+  cr_assert_eq(found, 0);
+}
+
+Test(SweepAndPrune, remove_and_clear) {
+  SweepAndPrune sap;
+  std::vector<SpatialHash::Pair> pairs;
+
+  sap.update(2, AABB(Vector(0, 0, 0), Vector(1, 1, 1)));
+  sap.update(5, AABB(Vector(1, 1, 1), Vector(2, 2, 2)));
+  sap.update(9, AABB(Vector(0.5f, 0, 0), Vector(0.6f, 0.1f, 0.1f)));
+  sap.pairs(pairs);
+  cr_assert(pairs == (std::vector<SpatialHash::Pair> {{2, 5}, {2, 9}}));
+
+  sap.remove(2);
+  sap.pairs(pairs);
+  cr_assert(pairs.empty());
+  sap.update(2, AABB(Vector(1.5f, 1.5f, 1.5f), Vector(3, 3, 3)));
+  sap.pairs(pairs);
+  cr_assert(pairs == (std::vector<SpatialHash::Pair> {{2, 5}}));
+
+  sap.clear();
+  sap.pairs(pairs);
+  cr_assert(pairs.empty());
+  cr_assert_eq(sap.size(), 0);
+}
+
+Test(SpatialHash, remove_and_sweep) {
+  SpatialHash hash(1);
+  std::vector<SpatialHash::Pair> pairs;
+
+  hash.update(0, AABB(Vector(-1.5f, -1.5f, -1.5f), Vector(-0.5f, -0.5f, -0.5f)));
+  hash.update(3, AABB(Vector(-0.7f, -0.7f, -0.7f), Vector(2, 2, 2)));
+  hash.update(7, AABB(Vector(1.5f, 1.5f, 1.5f), Vector(3, 3, 3)));
+  hash.sweep();
+  hash.pairs(pairs);
+  cr_assert(pairs == (std::vector<SpatialHash::Pair> {{0, 3}, {3, 7}}));
+
+  hash.remove(3);
+  hash.pairs(pairs);
+  cr_assert(pairs.empty());
+  cr_assert_eq(hash.size(), 2);
+
+  /* only 7 is updated, 0 is swept */
+  hash.update(7, AABB(Vector(-1, -1, -1), Vector(0, 0, 0)));
+  hash.sweep();
+  cr_assert(!hash.contains(0));
+  cr_assert(hash.contains(7));
+  cr_assert_eq(hash.size(), 1);
+  hash.clear();
+  cr_assert_eq(hash.size(), 0);
+  cr_assert_eq(hash.cells(), 0);
+}
+
+/* every length of tail after the batches of 8 */
+Test(BoxBatch, pairs_match_scalar) {
+  std::vector<AABB> boxes = make_boxes(40, 0.3f);
+  BoxArrays arrays;
+  std::vector<Broadphase::Pair> candidates;
+
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    arrays.set(i, boxes[i]);
+  }
+  cr_assert(arrays.get(5) == boxes[5]);
+  for (size_t a = 0; a < boxes.size(); ++a) {
+    for (size_t b = a + 1; b < boxes.size(); b += 3) {
+      candidates.emplace_back(a, b);
+    }
+  }
+  for (size_t count = 0; count < 24; ++count) {
+    std::vector<Broadphase::Pair> pairs(candidates.begin() + 100,
+                                        candidates.begin() + 100 + count);
+    std::vector<Broadphase::Pair> expected(count);
+
+    expected.resize(batch::overlapping_scalar(arrays, pairs.data(), count, expected.data()));
+    /* in place, as the broadphases do */
+    pairs.resize(batch::overlapping(arrays, pairs.data(), count, pairs.data()));
+    cr_assert(pairs == expected);
+  }
+
+  std::vector<Broadphase::Pair> pairs = candidates;
+  pairs.resize(batch::overlapping(arrays, pairs.data(), pairs.size(), pairs.data()));
+  cr_assert(pairs == brute_force(boxes));
+}
+
+/* boxes touching by a face or a corner overlap, a box with a NaN overlaps nothing */
+Test(BoxBatch, edge_boxes) {
+  float nan = std::nanf("");
+  std::vector<AABB> boxes = {
+      AABB(Vector(0, 0, 0), Vector(1, 1, 1)),     AABB(Vector(1, 0, 0), Vector(2, 1, 1)),
+      AABB(Vector(1, 1, 1), Vector(1, 1, 1)),     AABB(Vector(nan, 0, 0), Vector(1, 1, 1)),
+      AABB(Vector(0, 0, 0), Vector(1, nan, 1)),   AABB(Vector(2.001f, 0, 0), Vector(3, 1, 1)),
+      AABB(Vector(-1, -1, -1), Vector(5, 5, 5)),
+  };
+  BoxArrays arrays;
+  std::vector<Broadphase::Pair> pairs;
+  std::vector<Broadphase::Pair> expected;
+
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    arrays.set(i, boxes[i]);
+  }
+  /* every pair both ways and every box with itself, 49 pairs: 6 batches and a tail of 1 */
+  for (size_t a = 0; a < boxes.size(); ++a) {
+    for (size_t b = 0; b < boxes.size(); ++b) {
+      pairs.emplace_back(a, b);
+      if (boxes[a].intersects(boxes[b])) {
+        expected.emplace_back(a, b);
+      }
+    }
+  }
+  cr_assert(boxes[0].intersects(boxes[1]));
+  cr_assert(boxes[1].intersects(boxes[2]));
+  cr_assert(!boxes[3].intersects(boxes[6]));
+  pairs.resize(batch::overlapping(arrays, pairs.data(), pairs.size(), pairs.data()));
+  cr_assert(pairs == expected);
+
+  std::vector<uint32_t> found(boxes.size());
+  for (size_t index = 0; index < boxes.size(); ++index) {
+    std::vector<uint32_t> overlaps;
+
+    for (size_t other = 0; other < boxes.size(); ++other) {
+      if (boxes[index].intersects(boxes[other])) {
+        overlaps.push_back(other);
+      }
+    }
+    size_t count = batch::overlapping(arrays, index, 0, boxes.size(), found.data());
+    cr_assert(std::vector<uint32_t>(found.begin(), found.begin() + count) == overlaps);
+    cr_assert_eq(count == 0, index == 3 || index == 4);
+  }
+}
+
+Test(BoxBatch, one_against_many) {
+  std::vector<AABB> boxes = make_boxes(45, 1.1f);
+  BoxArrays arrays;
+  std::vector<uint32_t> found(boxes.size());
+
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    arrays.set(i, boxes[i]);
+  }
+  for (size_t index = 0; index < boxes.size(); ++index) {
+    for (size_t first : {size_t(0), index + 1}) {
+      std::vector<uint32_t> expected;
+
+      for (size_t other = first; other < boxes.size(); ++other) {
+        if (boxes[index].intersects(boxes[other])) {
+          expected.push_back(other);
+        }
+      }
+      size_t count = batch::overlapping(arrays, index, first, boxes.size(), found.data());
+      cr_assert(std::vector<uint32_t>(found.begin(), found.begin() + count) == expected);
+    }
+  }
+}
+
+static void exit_after_one(EventWriter<AppExit> exit) { exit.send(AppExit {}); }
+
+static void collide_in_app(BroadphaseKind kind, size_t threads = 0) {
+  App app;
+  if (threads) {
+    app.init_resource<TaskPool>(threads);
+  }
+  app.add_plugins(DefaultPlugin());
+  app.init_component<Transform>();
+  app.init_component<GlobalTransform>();
+  app.add_plugins(PhysicsPlugin(kind, 4));
+  app.add_systems<core_stage::Update>(exit_after_one);
+
+  size_t a = app.spawn(Transform(-1, 0, 0), Collider(Shape::box(Vector(1, 1, 1)))).id();
+  size_t b = app.spawn(Transform(0, 0, 0), Collider(Shape::box(Vector(0.5f, 0.5f, 0.5f)))).id();
+  app.spawn(Transform(10, 0, 0), Collider(Shape::box(Vector(0.5f, 0.5f, 0.5f))));
+  app.run();
+
+  auto &pairs = app.resource<BroadphasePairs>().pairs;
+  cr_assert(pairs == (std::vector<SpatialHash::Pair> {{a, b}}));
+}
+
+Test(PhysicsPlugin, spatial_hash) {
+  collide_in_app(BroadphaseKind::SpatialHash);
+}
+
+Test(PhysicsPlugin, sweep_and_prune) {
+  collide_in_app(BroadphaseKind::SweepAndPrune);
+}
+
+Test(PhysicsPlugin, dynamic_tree) {
+  collide_in_app(BroadphaseKind::DynamicTree);
+}
+
+Test(PhysicsPlugin, with_task_pool) {
+  collide_in_app(BroadphaseKind::SpatialHash, 4);
+}
+
+Test(ContactCache, start_stay_end) {
+  App app;
+  Entity a = app.spawn().id();
+  Entity b = app.spawn().id();
+  Entity c = app.spawn().id();
+  ContactCache contacts;
+  Shape box = Shape::box(Vector(1, 1, 1));
+  Shape moved = box;
+  moved.set_transform(Vector(0.5f, 0, 0), glm::identity<glm::quat>());
+  size_t tests = 0;
+  auto touch = [&]() {
+    tests += 1;
+    return true;
+  };
+  auto miss = [&]() {
+    tests += 1;
+    return false;
+  };
+  std::vector<size_t> ended;
+  auto end = [&](Entity first, Entity second) {
+    ended.push_back(first);
+    ended.push_back(second);
+  };
+
+  cr_assert(contacts.update(a, b, box, box, touch) == ContactCache::Change::Started);
+  cr_assert(contacts.update(a, c, box, box, miss) == ContactCache::Change::None);
+  contacts.end_frame(end);
+  cr_assert(contacts.touching(a, b) && contacts.touching(b, a));
+  cr_assert(!contacts.touching(a, c));
+  cr_assert_eq(contacts.size(), 2);
+
+  /* same shapes, the results are reused */
+  cr_assert(contacts.update(a, b, box, box, miss) == ContactCache::Change::None);
+  cr_assert(contacts.update(a, c, box, box, touch) == ContactCache::Change::None);
+  contacts.end_frame(end);
+  cr_assert_eq(tests, 2);
+  cr_assert_eq(contacts.reused(), 2);
+
+  cr_assert(contacts.update(a, b, box, moved, miss) == ContactCache::Change::Ended);
+  cr_assert(contacts.update(a, c, moved, box, touch) == ContactCache::Change::Started);
+  contacts.end_frame(end);
+  cr_assert(ended.empty());
+
+  /* pairs no longer found by the broadphase end if they were touching */
+  contacts.update(b, c, box, box, touch);
+  contacts.end_frame(end);
+  cr_assert(ended == (std::vector<size_t> {a, c}));
+  cr_assert_eq(contacts.size(), 1);
+  cr_assert(contacts.find(a, b) == nullptr);
+  contacts.clear();
+  cr_assert_eq(contacts.size(), 0);
+}
+
+/* events of a few frames of moving spheres, every pair pushed, with or without workers */
+static std::vector<size_t> pushed_events(const std::vector<Entity> &entities, TaskPool *pool) {
+  ContactCache contacts;
+  std::vector<size_t> events;
+  auto record = [&](size_t kind) {
+    return [&events, kind](Entity first, Entity second) {
+      events.insert(events.end(), {kind, first, second});
+    };
+  };
+
+  for (size_t frame = 0; frame < 4; ++frame) {
+    std::vector<Shape> shapes;
+
+    for (size_t i = 0; i < entities.size(); ++i) {
+      float f = float(i) + float(frame) * 0.3f;
+      Shape shape = i % 2 ? Shape::sphere(1) : Shape::box(Vector(1, 0.5f, 1));
+
+      shape.set_transform(Vector(std::sin(f) * 8, std::cos(f * 1.7f) * 8, 0),
+                          glm::identity<glm::quat>());
+      shapes.push_back(shape);
+    }
+    for (size_t a = 0; a < entities.size(); ++a) {
+      for (size_t b = a + 1; b < entities.size(); ++b) {
+        contacts.push(entities[a], entities[b], shapes[a], shapes[b]);
+      }
+    }
+    cr_assert_gt(contacts.pushed(), ContactCache::parallel_threshold);
+    contacts.update_pushed(pool, record(0), record(1));
+    contacts.end_frame(record(2));
+    cr_assert_eq(contacts.pushed(), 0);
+  }
+  return events;
+}
+
+Test(ContactCache, pushed_in_parallel) {
+  App app;
+  std::vector<Entity> entities;
+
+  for (size_t i = 0; i < 110; ++i) {
+    entities.push_back(app.spawn().id());
+  }
+  TaskPool pool(4);
+  std::vector<size_t> serial = pushed_events(entities, nullptr);
+
+  cr_assert(!serial.empty());
+  cr_assert(pushed_events(entities, &pool) == serial);
+  cr_assert(pushed_events(entities, &pool) == serial);
+}
+
+struct CollisionScript {
+  size_t frame = 0;
+  size_t moving;
+  /* frame, started, first, second */
+  std::vector<std::tuple<size_t, bool, size_t, size_t>> events;
+};
+
+/* the moving entity leaves at frame 3 and comes back at frame 4, the whole Transform is
+   assigned to set its world position without the Engine */
+static void move_collider(Query<Entity, Transform> transforms, Resource<CollisionScript> script,
+                          EventWriter<AppExit> exit) {
+  script->frame += 1;
+  for (auto [entity, transform] : transforms) {
+    if (size_t(entity) == script->moving && script->frame == 3) {
+      transform = Transform(5, 0, 0);
+    } else if (size_t(entity) == script->moving && script->frame == 4) {
+      transform = Transform(0, 0, 0);
+    }
+  }
+  if (script->frame == 5) {
+    exit.send(AppExit {});
+  }
+}
+
+static void record_collisions(EventReader<CollisionStarted> started,
+                              EventReader<CollisionEnded> ended,
+                              Resource<CollisionScript> script) {
+  for (const auto &event : started) {
+    script->events.emplace_back(script->frame, true, event.first, event.second);
+  }
+  for (const auto &event : ended) {
+    script->events.emplace_back(script->frame, false, event.first, event.second);
+  }
+}
+
+Test(PhysicsPlugin, collision_events) {
+  App app;
+  app.add_plugins(DefaultPlugin());
+  app.init_component<Transform>();
+  app.init_component<GlobalTransform>();
+  app.add_plugins(PhysicsPlugin(BroadphaseKind::DynamicTree, 4, 0.1f));
+  app.init_resource<CollisionScript>();
+  app.add_systems<core_stage::PreUpdate>(move_collider);
+  app.add_systems<core_stage::PostUpdate>(record_collisions);
+
+  size_t a = app.spawn(Transform(-1, 0, 0), Collider(Shape::box(Vector(1, 1, 1)))).id();
+  size_t b = app.spawn(Transform(0, 0, 0), Collider(Shape::box(Vector(0.5f, 0.5f, 0.5f)))).id();
+  app.spawn(Transform(10, 0, 0), Collider(Shape::box(Vector(0.5f, 0.5f, 0.5f))));
+  app.resource<CollisionScript>().moving = b;
+  app.run();
+
+  auto &events = app.resource<CollisionScript>().events;
+  cr_assert(events == (std::vector<std::tuple<size_t, bool, size_t, size_t>> {
+                          {1, true, a, b}, {3, false, a, b}, {4, true, a, b}}));
+  cr_assert_eq(app.resource<ContactCache>().size(), 1);
+  cr_assert(app.resource<ContactCache>().reused() >= 1);
+}
+
+/* at frame 3 the moving entity is despawned, and its id given at once to a new collider
+   at the same place, which must not inherit its contact: the contact ends and a new one
+   starts, recorded started first */
+static void respawn_collider(World &world) {
+  auto &script = world.resource<CollisionScript>();
+
+  script.frame += 1;
+  if (script.frame == 3) {
+    world.despawn(world.entities()[script.moving].value());
+    script.moving = world.spawn(Transform(0, 0, 0), Collider(Shape::box(Vector(0.5f, 0.5f, 0.5f))))
+                        .id();
+  }
+  if (script.frame == 4) {
+    world.despawn(world.entities()[script.moving].value());
+  }
+  if (script.frame == 5) {
+    world.resource<Event<AppExit>>().send(AppExit {});
+  }
+}
+
+Test(PhysicsPlugin, despawn_then_respawn) {
+  for (auto kind : {BroadphaseKind::SpatialHash, BroadphaseKind::SweepAndPrune,
+                    BroadphaseKind::DynamicTree}) {
+    App app;
+    app.add_plugins(DefaultPlugin());
+    app.init_component<Transform>();
+    app.init_component<GlobalTransform>();
+    app.add_plugins(PhysicsPlugin(kind, 4, 0.1f));
+    app.init_resource<CollisionScript>();
+    app.add_systems<core_stage::PreUpdate>(respawn_collider);
+    app.add_systems<core_stage::PostUpdate>(record_collisions);
+
+    size_t a = app.spawn(Transform(-1, 0, 0), Collider(Shape::box(Vector(1, 1, 1)))).id();
+    size_t b = app.spawn(Transform(0, 0, 0), Collider(Shape::box(Vector(0.5f, 0.5f, 0.5f)))).id();
+    app.resource<CollisionScript>().moving = b;
+    app.run();
+
+    auto &script = app.resource<CollisionScript>();
+    cr_assert_eq(script.moving, b);
+    cr_assert(script.events == (std::vector<std::tuple<size_t, bool, size_t, size_t>> {
+                                   {1, true, a, b}, {3, true, a, b}, {3, false, a, b},
+                                   {4, false, a, b}}));
+    cr_assert_eq(app.resource<ContactCache>().size(), 0);
+  }
+}
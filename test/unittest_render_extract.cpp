@@ -0,0 +1,123 @@
+#include <criterion/criterion.h>
+
+#include "App.hpp"
+#include "DefaultPlugin.hpp"
+#include "ForwardRenderer.hpp"
+#include "GlobalTransform.hpp"
+#include "Hierarchy.hpp"
+#include "glWindow.hpp"
+
+using namespace cevy::ecs;
+using cevy::engine::Camera;
+using cevy::engine::Children;
+using cevy::engine::Color;
+using cevy::engine::GlobalTransform;
+using cevy::engine::Handle;
+using cevy::engine::Hierarchy;
+using cevy::engine::Model;
+using cevy::engine::Parent;
+using cevy::engine::PbrMaterial;
+using cevy::engine::PointLight;
+using cevy::engine::Transform;
+using Window = glWindow<cevy::engine::ForwardRenderer>;
+
+static void exit_after_one(EventWriter<AppExit> exit) { exit.send(AppExit {}); }
+
+/* what a pipelined frame does, without the window: extract, then the queries of the renderer */
+Test(glWindow, extract_for_renderer) {
+  App app;
+  app.add_plugins(DefaultPlugin());
+  app.init_component<Camera>();
+  app.init_component<Transform>();
+  app.init_component<Parent>();
+  app.init_component<Children>();
+  app.init_component<GlobalTransform>();
+  app.init_component<Handle<Model>>();
+  app.init_component<Handle<PbrMaterial>>();
+  app.init_component<Color>();
+  app.init_component<PointLight>();
+  app.add_systems<core_stage::PreUpdate>(Hierarchy::sync_children, Hierarchy::propagate).chain();
+  app.add_systems<core_stage::Update>(exit_after_one);
+
+  Entity root = app.spawn(Transform(0, 3, 0));
+  app.spawn(Transform(1, 0, 0), Parent {root}, PointLight {});
+  app.run();
+
+  World render_world;
+  Window::init_render_world(render_world);
+  Window::extract(render_world, app);
+
+  Query<option<Transform>, option<GlobalTransform>, Handle<Model>, option<Handle<PbrMaterial>>,
+        option<Color>>
+      models(render_world);
+  Query<option<Transform>, option<GlobalTransform>, PointLight> lights(render_world);
+
+  size_t drawn = 0;
+  size_t lit = 0;
+
+  for (auto model : models) {
+    (void)model;
+    drawn += 1;
+  }
+  for (auto [transform, global, light] : lights) {
+    glm::vec3 position = cevy::engine::world_position(transform, global);
+
+    lit += 1;
+    cr_assert(global.has_value());
+    cr_assert_float_eq(position.x, 1, 1e-5);
+    cr_assert_float_eq(position.y, 3, 1e-5);
+  }
+  cr_assert_eq(drawn, 0);
+  cr_assert_eq(lit, 1);
+}
+
+Test(glWindow, extract_only_rendered) {
+  App app;
+  app.init_component<Camera>();
+  app.init_component<Transform>();
+  app.init_component<GlobalTransform>();
+  app.init_component<Handle<Model>>();
+  app.init_component<Handle<PbrMaterial>>();
+  app.init_component<Color>();
+  app.init_component<PointLight>();
+
+  for (int i = 0; i < 10; ++i) {
+    app.spawn(Transform(i, 0, 0));
+  }
+  Entity first = app.spawn(Transform(10, 0, 0), PointLight {});
+  app.spawn(Transform(11, 0, 0));
+  Entity second = app.spawn(Transform(12, 0, 0), Color(1, 0, 0), PointLight {});
+  for (int i = 0; i < 100; ++i) {
+    app.spawn(Transform(i, 1, 0));
+  }
+
+  World render_world;
+  Window::init_render_world(render_world);
+  Window::extract(render_world, app);
+
+  auto &extracted = render_world.entities();
+  auto &transforms = render_world.get_components<Transform>();
+  auto &colors = render_world.get_components<Color>();
+
+  cr_assert_eq(extracted.size(), 2);
+  cr_assert_eq(size_t(*extracted[0]), size_t(first));
+  cr_assert_eq(size_t(*extracted[1]), size_t(second));
+  cr_assert_float_eq(transforms[0]->position.x, 10, 1e-5);
+  cr_assert_float_eq(transforms[1]->position.x, 12, 1e-5);
+  cr_assert(!colors[0].has_value());
+  cr_assert(colors[1].has_value());
+  cr_assert_lt(transforms.size(), 3);
+
+  /* a despawned light leaves no stale slot behind on the next extract */
+  app.despawn(first);
+  Window::extract(render_world, app);
+
+  size_t lit = 0;
+  for (auto [transform, light] : Query<Transform, PointLight>(render_world)) {
+    (void)light;
+    lit += 1;
+    cr_assert_float_eq(transform.position.x, 12, 1e-5);
+  }
+  cr_assert_eq(extracted.size(), 1);
+  cr_assert_eq(lit, 1);
+}
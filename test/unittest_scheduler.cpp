@@ -0,0 +1,331 @@
+#include <criterion/criterion.h>
+
+#include "App.hpp"
+#include "Budget.hpp"
+#include "Condition.hpp"
+#include "DefaultPlugin.hpp"
+#include "FrameStats.hpp"
+#include "SystemStats.hpp"
+#include "TaskPool.hpp"
+
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace cevy::ecs;
+
+struct Frames {
+  size_t count = 0;
+};
+
+struct Counter {
+  size_t count = 0;
+};
+
+struct Toggle {
+  bool on = false;
+  bool operator==(const Toggle &other) const { return on == other.on; }
+};
+
+static void count_frames(Resource<Frames> frames, EventWriter<AppExit> exit) {
+  frames->count += 1;
+  if (frames->count >= 6) {
+    exit.send(AppExit {});
+  }
+}
+
+static void count(Resource<Counter> counter) { counter->count += 1; }
+
+static bool is_even_frame(Resource<Frames> frames) { return frames->count % 2 == 0; }
+
+static App make_app() {
+  App app;
+  app.add_plugins(DefaultPlugin());
+  app.init_resource<Frames>();
+  app.init_resource<Counter>();
+  app.add_systems<core_stage::First>(count_frames);
+  return app;
+}
+
+Test(Scheduler, run_if_function) {
+  App app = make_app();
+  app.add_systems<core_stage::Update>(count).run_if(is_even_frame);
+  app.run();
+  cr_assert(app.resource<Counter>().count == 3);
+}
+
+Test(Scheduler, run_if_every_n_ticks) {
+  App app = make_app();
+  app.add_systems<core_stage::Update>(count).run_if(condition::every_n_ticks(3));
+  app.run();
+  cr_assert(app.resource<Counter>().count == 2);
+}
+
+Test(Scheduler, run_if_combined) {
+  App app = make_app();
+  app.add_systems<core_stage::Update>(count)
+      .run_if(condition::resource_exists<Counter>())
+      .run_if(condition::resource_exists<Toggle>());
+  app.run();
+  cr_assert(app.resource<Counter>().count == 0);
+}
+
+Test(Scheduler, run_if_resource_changed) {
+  App app = make_app();
+  app.init_resource<Toggle>();
+  app.add_systems<core_stage::Update>(count).run_if(condition::resource_changed<Toggle>());
+  app.run();
+  cr_assert(app.resource<Counter>().count == 1);
+}
+
+struct Hit {};
+
+static void hit_on_even_frame(Resource<Frames> frames, EventWriter<Hit> hits) {
+  if (frames->count % 2 == 0) {
+    hits.send(Hit {});
+  }
+}
+
+static bool was_hit(EventReader<Hit> hits) { return !hits.empty(); }
+
+/* events are kept for two frames, a gated system must still run once per event */
+Test(Scheduler, run_if_on_event) {
+  App app = make_app();
+  app.add_event<Hit>();
+  app.add_systems<core_stage::Update>(hit_on_even_frame);
+  app.add_systems<core_stage::PostUpdate>(count).run_if(condition::on_event<Hit>());
+  app.run();
+  cr_assert_eq(app.resource<Counter>().count, 3);
+}
+
+Test(Scheduler, run_if_event_reader) {
+  App app = make_app();
+  app.add_event<Hit>();
+  app.add_systems<core_stage::Update>(hit_on_even_frame);
+  app.add_systems<core_stage::PostUpdate>(count).run_if(was_hit);
+  app.run();
+  cr_assert_eq(app.resource<Counter>().count, 3);
+}
+
+Test(Scheduler, system_stats) {
+  App app = make_app();
+  app.init_resource<SystemStats>(4);
+  app.add_systems<core_stage::Update>(count).named("count");
+  app.run();
+
+  auto &stats = app.resource<SystemStats>();
+  auto summary = stats.summary("count");
+  cr_assert(summary.has_value());
+  cr_assert_eq(summary->samples, 6);
+  cr_assert(stats.summary("Update").has_value());
+  cr_assert_eq(stats.frame_count(), 7);
+
+  std::ostringstream trace;
+  stats.export_chrome_trace(trace);
+  cr_assert(trace.str().find("\"name\":\"count\"") != std::string::npos);
+}
+
+static void slow_fourth_frame(Resource<Counter> counter) {
+  counter->count += 1;
+  if (counter->count == 4) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(8));
+  }
+}
+
+Test(Scheduler, frame_stats) {
+  App app = make_app();
+  app.init_resource<FrameStats>(4, 5.0);
+  app.init_resource<Counter>();
+  app.add_systems<core_stage::Update>(slow_fourth_frame);
+  app.run();
+
+  auto &stats = app.resource<FrameStats>();
+  auto frame = stats.frame();
+  /* frames are measured from one start to the next, the last one is not complete */
+  cr_assert_eq(stats.frame_count(), 5);
+  cr_assert_eq(frame.samples, 4);
+  cr_assert(frame.max >= 8 && frame.hitches >= 1 && stats.total_hitches() >= 1);
+  cr_assert(frame.p50 <= frame.p95 && frame.p95 <= frame.p99 && frame.p99 <= frame.max);
+
+  auto update = stats.stage("Update");
+  cr_assert(update.has_value() && update->max >= 8);
+  cr_assert(!stats.stage("Startup").has_value());
+
+  std::stringstream csv;
+  stats.export_csv(csv);
+  std::string line;
+  size_t lines = 0;
+  while (std::getline(csv, line)) {
+    lines += 1;
+  }
+  cr_assert_eq(lines, 2 + stats.stages().size());
+}
+
+struct Log {
+  std::vector<int> values;
+};
+
+struct Other {
+  int value = 0;
+};
+
+static void log_one(Resource<Log> log) { log->values.push_back(1); }
+static void log_two(Resource<Log> log) { log->values.push_back(2); }
+static void log_three(Resource<Log> log) { log->values.push_back(3); }
+static void copy_log(Resource<Log> log, Resource<Other> other) {
+  other->value = log->values.empty() ? 0 : log->values.back();
+}
+
+static App make_ordered_app(size_t threads) {
+  App app = make_app();
+  app.init_resource<Log>();
+  app.init_resource<Other>();
+  app.init_resource<TaskPool>(threads);
+  return app;
+}
+
+Test(Scheduler, order_after_function) {
+  App app = make_ordered_app(1);
+  app.add_systems<core_stage::Update>(log_two).after(log_one);
+  app.add_systems<core_stage::Update>(log_one);
+  app.run();
+  auto &values = app.resource<Log>().values;
+  cr_assert_eq(values.size(), 12);
+  for (size_t i = 0; i < values.size(); i += 2) {
+    cr_assert_eq(values[i], 1);
+    cr_assert_eq(values[i + 1], 2);
+  }
+}
+
+Test(Scheduler, order_sets_and_chain) {
+  App app = make_ordered_app(4);
+  app.add_systems<core_stage::Update>(copy_log).after("logging");
+  app.add_systems<core_stage::Update>(log_three, log_two, log_one).chain().in_set("logging");
+  app.run();
+  auto &values = app.resource<Log>().values;
+  cr_assert_eq(values.size(), 18);
+  for (size_t i = 0; i < values.size(); i += 3) {
+    cr_assert_eq(values[i], 3);
+    cr_assert_eq(values[i + 1], 2);
+    cr_assert_eq(values[i + 2], 1);
+  }
+  cr_assert_eq(app.resource<Other>().value, 1);
+}
+
+Test(Scheduler, order_before_config) {
+  App app = make_ordered_app(4);
+  auto last = app.add_systems<core_stage::Update>(log_one);
+  app.add_systems<core_stage::Update>(log_two).before(last);
+  app.run();
+  auto &values = app.resource<Log>().values;
+  cr_assert_eq(values.front(), 2);
+  cr_assert_eq(values.back(), 1);
+}
+
+Test(Scheduler, order_cycle) {
+  App app = make_ordered_app(1);
+  app.add_systems<core_stage::Update>(log_one).after(log_two);
+  app.add_systems<core_stage::Update>(log_two).after(log_one);
+  bool thrown = false;
+  try {
+    app.run();
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+  cr_assert(thrown);
+}
+
+struct Work {
+  size_t done = 0;
+};
+
+static void budgeted_range(Resource<Counter> counter, Budget budget) {
+  budget.for_range(10, [&counter](size_t) { counter->count += 1; });
+}
+
+static void budgeted_query(Query<Work> works, Budget budget) {
+  budget.for_each(works, [](auto item) { std::get<Work &>(item).done += 1; });
+}
+
+Test(Scheduler, budget_range) {
+  App app = make_app();
+  auto config = app.add_systems<core_stage::Update>(budgeted_range).with_budget(3);
+  app.run();
+  auto budget = config.budget();
+  cr_assert_eq(app.resource<Counter>().count, 16);
+  cr_assert_eq(budget->passes, 1);
+  cr_assert_eq(budget->cursor, 6);
+  cr_assert(budget->exhausted);
+}
+
+Test(Scheduler, budget_query) {
+  App app = make_app();
+  app.init_component<Work>();
+  for (size_t i = 0; i < 7; ++i) {
+    app.spawn(Work {});
+  }
+  auto config = app.add_systems<core_stage::Update>(budgeted_query).with_budget(2);
+  app.run();
+  size_t total = 0;
+  for (auto [work] : Query<Work>::query(app)) {
+    total += work.done;
+  }
+  cr_assert_eq(total, 11);
+  cr_assert_eq(config.budget()->passes, 1);
+  cr_assert_eq(config.budget()->cursor, 4);
+}
+
+Test(TaskPool, parallel_for) {
+  TaskPool pool(4);
+  std::vector<int> visits(1000);
+  std::vector<size_t> firsts(1000);
+
+  pool.parallel_for(visits.size(), 64, [&](size_t first, size_t last) {
+    for (size_t i = first; i < last; ++i) {
+      visits[i] += 1;
+      firsts[i] = first;
+    }
+  });
+  for (size_t i = 0; i < visits.size(); ++i) {
+    cr_assert_eq(visits[i], 1);
+    cr_assert_eq(firsts[i] % 64, 0);
+  }
+
+  size_t calls = 0;
+  pool.parallel_for(0, 64, [&](size_t, size_t) { calls += 1; });
+  TaskPool(1).parallel_for(10, 64, [&](size_t first, size_t last) {
+    calls += 1;
+    cr_assert_eq(first, 0);
+    cr_assert_eq(last, 10);
+  });
+  cr_assert_eq(calls, 1);
+}
+
+/* the ranges reference the caller's frame, all of them end before the error is rethrown */
+Test(TaskPool, parallel_for_throwing_range) {
+  TaskPool pool(4);
+
+  for (size_t throwing : {size_t(0), size_t(5)}) {
+    std::vector<std::atomic<int>> visits(1000);
+    bool thrown = false;
+
+    try {
+      pool.parallel_for(visits.size(), 64, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+          visits[i] += 1;
+        }
+        if (first <= throwing * 64 && throwing * 64 < last) {
+          throw std::runtime_error("range");
+        }
+      });
+    } catch (const std::runtime_error &) {
+      thrown = true;
+    }
+    cr_assert(thrown);
+    for (auto &visit : visits) {
+      cr_assert_eq(visit.load(), 1);
+    }
+  }
+}
@@ -0,0 +1,101 @@
+#include <criterion/criterion.h>
+
+#include "Shape.hpp"
+
+#include <cmath>
+
+#include <glm/gtc/quaternion.hpp>
+
+using cevy::engine::AABB;
+using cevy::engine::Vector;
+using cevy::physics::Shape;
+
+static constexpr float eighth_turn = 0.785398f;
+static constexpr float quarter_turn = 1.570796f;
+
+static Shape place(Shape shape, const Vector &position, float angle_z = 0) {
+  shape.set_transform(position, glm::quat(glm::vec3(0, 0, angle_z)));
+  return shape;
+}
+
+static void assert_touch(const Shape &a, const Shape &b, bool expected) {
+  cr_assert_eq(a.intersects(b), expected);
+  cr_assert_eq(b.intersects(a), expected);
+}
+
+Test(Shape, spheres) {
+  Shape sphere = place(Shape::sphere(1), Vector(0, 0, 0));
+
+  assert_touch(sphere, place(Shape::sphere(0.5f), Vector(1.4f, 0, 0)), true);
+  assert_touch(sphere, place(Shape::sphere(0.5f), Vector(1.6f, 0, 0)), false);
+  /* near the corner of the box, outside of it */
+  assert_touch(sphere, place(Shape::box(Vector(1, 1, 1)), Vector(1.8f, 1.8f, 0)), false);
+  assert_touch(sphere, place(Shape::box(Vector(1, 1, 1)), Vector(1.6f, 0.5f, 0)), true);
+  assert_touch(sphere, place(Shape::oriented_box(Vector(1, 1, 1)), Vector(2.3f, 0, 0), eighth_turn),
+               true);
+  assert_touch(sphere, place(Shape::oriented_box(Vector(1, 1, 1)), Vector(2.5f, 0, 0), eighth_turn),
+               false);
+  assert_touch(sphere, place(Shape::capsule(0.5f, 1), Vector(1.4f, 0.9f, 0)), true);
+  assert_touch(sphere, place(Shape::capsule(0.5f, 1), Vector(0.5f, 2.6f, 0)), false);
+}
+
+Test(Shape, boxes) {
+  Shape diamond = place(Shape::oriented_box(Vector(1, 1, 1)), Vector(0, 0, 0), eighth_turn);
+  Shape cube = Shape::oriented_box(Vector(1, 1, 1));
+
+  /* the bounds overlap, the rotated box doesn't reach the corner */
+  Shape corner = place(Shape::box(Vector(0.5f, 0.5f, 0.5f)), Vector(1.8f, 1.8f, 0));
+  cr_assert(diamond.bounds().intersects(corner.bounds()));
+  assert_touch(diamond, corner, false);
+  assert_touch(diamond, place(Shape::box(Vector(1, 1, 1)), Vector(2.3f, 0, 0)), true);
+  assert_touch(diamond, place(Shape::box(Vector(1, 1, 1)), Vector(2.5f, 0, 0)), false);
+  assert_touch(diamond, place(cube, Vector(2.7f, 0, 0), eighth_turn), true);
+  assert_touch(diamond, place(cube, Vector(2.9f, 0, 0), eighth_turn), false);
+
+  /* without rotation, the separating axis test agrees with the bounds */
+  for (float x = -2.45f; x < 2.5f; x += 0.3f) {
+    for (float y = -2.45f; y < 2.5f; y += 0.3f) {
+      Shape box = place(Shape::box(Vector(1, 0.5f, 1)), Vector(x, y, 0.2f));
+      Shape oriented = place(Shape::oriented_box(Vector(0.7f, 1, 0.4f)), Vector(0, 0, 0));
+
+      assert_touch(box, oriented, box.bounds().intersects(oriented.bounds()));
+    }
+  }
+}
+
+Test(Shape, capsules) {
+  /* along x once rotated */
+  Shape capsule = place(Shape::capsule(0.5f, 2), Vector(0, 0, 0), quarter_turn);
+  Shape small = Shape::oriented_box(Vector(0.5f, 0.5f, 0.5f));
+
+  assert_touch(capsule, place(Shape::box(Vector(0.5f, 0.5f, 0.5f)), Vector(2.9f, 0, 0)), true);
+  assert_touch(capsule, place(Shape::box(Vector(0.5f, 0.5f, 0.5f)), Vector(3.1f, 0, 0)), false);
+  assert_touch(capsule, place(Shape::box(Vector(0.5f, 0.5f, 0.5f)), Vector(0, 0.9f, 0)), true);
+  assert_touch(capsule, place(Shape::box(Vector(0.5f, 0.5f, 0.5f)), Vector(0, 1.2f, 0)), false);
+  assert_touch(capsule, place(small, Vector(1, 1.1f, 0), eighth_turn), true);
+  assert_touch(capsule, place(small, Vector(1, 1.3f, 0), eighth_turn), false);
+
+  /* crossing, parallel, and end to end */
+  assert_touch(capsule, place(Shape::capsule(0.5f, 2), Vector(1, 0.5f, 0.9f)), true);
+  assert_touch(capsule, place(Shape::capsule(0.5f, 2), Vector(1, 0.5f, 1.1f)), false);
+  assert_touch(capsule, place(Shape::capsule(0.2f, 2), Vector(0, 0.6f, 0), quarter_turn), true);
+  assert_touch(capsule, place(Shape::capsule(0.2f, 2), Vector(0, 0.8f, 0), quarter_turn), false);
+  assert_touch(capsule, place(Shape::capsule(0.5f, 1), Vector(3.9f, 0, 0), quarter_turn), true);
+  assert_touch(capsule, place(Shape::capsule(0.5f, 1), Vector(4.1f, 0, 0), quarter_turn), false);
+}
+
+Test(Shape, bounds) {
+  AABB sphere = place(Shape::sphere(2), Vector(1, 0, 0)).bounds();
+  AABB capsule = place(Shape::capsule(0.5f, 2), Vector(0, 0, 0), quarter_turn).bounds();
+  AABB diamond = place(Shape::oriented_box(Vector(1, 1, 1)), Vector(0, 0, 0), eighth_turn).bounds();
+
+  cr_assert(sphere.min == Vector(-1, -2, -2) && sphere.max == Vector(3, 2, 2));
+  cr_assert_float_eq(capsule.max.x, 2.5f, 1e-5);
+  cr_assert_float_eq(capsule.max.y, 0.5f, 1e-5);
+  cr_assert_float_eq(diamond.max.x, std::sqrt(2.f), 1e-5);
+  cr_assert_float_eq(diamond.max.z, 1, 1e-5);
+
+  /* a box stays aligned with the world */
+  Shape box = place(Shape::box(Vector(1, 2, 3)), Vector(0, 0, 0), 0.5f);
+  cr_assert(box.bounds().max == Vector(1, 2, 3));
+}
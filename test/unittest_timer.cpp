@@ -0,0 +1,91 @@
+#include <criterion/criterion.h>
+
+#include "TimerWheel.hpp"
+#include "World.hpp"
+
+#include <chrono>
+#include <vector>
+
+using namespace cevy::ecs;
+using std::chrono::milliseconds;
+
+static std::vector<size_t> advance(TimerWheel &wheel, milliseconds delta) {
+  std::vector<size_t> finished;
+
+  wheel.advance(delta, [&finished](const TimerFinished &timer) {
+    finished.push_back(size_t(timer.entity));
+  });
+  return finished;
+}
+
+Test(TimerWheel, expires_in_order) {
+  World world;
+  TimerWheel wheel;
+  std::vector<Entity> entities;
+  /* across the buckets of the first three levels */
+  std::vector<int> durations = {5000, 3, 64, 65, 4100, 1, 200};
+
+  for (int duration : durations) {
+    Entity e = world.spawn_empty().id();
+    entities.push_back(e);
+    wheel.start(e, milliseconds(duration));
+  }
+  cr_assert(wheel.size() == durations.size());
+  std::vector<size_t> order;
+  int elapsed = 0;
+  while (elapsed < 6000) {
+    for (size_t e : advance(wheel, milliseconds(1))) {
+      cr_assert(durations[e] == elapsed + 1);
+      order.push_back(e);
+    }
+    elapsed += 1;
+  }
+  cr_assert(order == std::vector<size_t>({5, 1, 2, 3, 6, 4, 0}));
+  cr_assert(wheel.size() == 0);
+}
+
+Test(TimerWheel, repeating_and_cancel) {
+  World world;
+  TimerWheel wheel;
+  Entity a = world.spawn_empty().id();
+  Entity b = world.spawn_empty().id();
+  TimerId repeating = wheel.start(a, milliseconds(10), TimerWheel::Repeating);
+  TimerId canceled = wheel.start(b, milliseconds(15));
+
+  cr_assert(wheel.running(repeating) && wheel.running(canceled));
+  cr_assert(wheel.cancel(canceled));
+  cr_assert(!wheel.running(canceled) && !wheel.cancel(canceled));
+
+  size_t times = 0;
+  for (int frame = 0; frame < 10; ++frame) {
+    wheel.advance(milliseconds(7), [&](const TimerFinished &timer) {
+      cr_assert(timer.timer == repeating);
+      times += timer.times;
+    });
+  }
+  cr_assert(times == 7);
+  /* a single long frame reports every expiry at once */
+  wheel.advance(milliseconds(95), [&](const TimerFinished &timer) { times += timer.times; });
+  cr_assert(times == 16);
+  cr_assert(wheel.running(repeating) && wheel.size() == 1);
+
+  /* the slot of the canceled timer is reused with a new generation */
+  TimerId reused = wheel.start(b, milliseconds(1));
+  cr_assert(reused.index == canceled.index && !wheel.running(canceled));
+}
+
+Test(TimerWheel, long_jump) {
+  World world;
+  TimerWheel wheel;
+  Entity e = world.spawn_empty().id();
+  size_t finished = 0;
+
+  wheel.start(e, std::chrono::hours(10));
+  wheel.start(e, std::chrono::hours(30));
+  wheel.advance(std::chrono::hours(20), [&](const TimerFinished &) { finished += 1; });
+  cr_assert(finished == 1 && wheel.size() == 1);
+  wheel.advance(std::chrono::hours(9), [&](const TimerFinished &) { finished += 1; });
+  cr_assert(finished == 1);
+  wheel.advance(std::chrono::hours(1), [&](const TimerFinished &) { finished += 1; });
+  cr_assert(finished == 2 && wheel.size() == 0);
+}
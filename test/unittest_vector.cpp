@@ -0,0 +1,145 @@
+#include <criterion/criterion.h>
+
+#include "AABB.hpp"
+#include "Vector.hpp"
+#include "VectorBatch.hpp"
+
+#include <cmath>
+#include <vector>
+
+using cevy::engine::AABB;
+using cevy::engine::Vector;
+namespace batch = cevy::engine::batch;
+
+static std::vector<Vector> make_vectors(size_t count, float seed) {
+  std::vector<Vector> vectors;
+
+  for (size_t i = 0; i < count; ++i) {
+    float f = float(i) + seed;
+    vectors.emplace_back(std::sin(f) * f, std::cos(f * 0.7f) * 3, f * 0.25f - 2);
+  }
+  /* normalize leaves tiny vectors as they are */
+  vectors[count / 2] = Vector(0.001f, 0, 0);
+  return vectors;
+}
+
+static void assert_near(const Vector &a, const Vector &b) {
+  cr_assert_float_eq(a.x, b.x, 1e-4);
+  cr_assert_float_eq(a.y, b.y, 1e-4);
+  cr_assert_float_eq(a.z, b.z, 1e-4);
+  cr_assert_eq(a.w, 0);
+}
+
+Test(Vector, operators) {
+  Vector a(1, 2, 3);
+  Vector b(-4, 5, 0.5f);
+
+  cr_assert_float_eq(a * b, 7.5f, 1e-6);
+  cr_assert_float_eq(a.eval(), 14, 1e-6);
+  assert_near(a.cross(b), Vector(2 * 0.5f - 3 * 5, 3 * -4 - 1 * 0.5f, 1 * 5 - 2 * -4));
+  assert_near(a + b, Vector(-3, 7, 3.5f));
+  assert_near(a - b, Vector(5, -3, 2.5f));
+  assert_near(a.scale(b), Vector(-4, 10, 1.5f));
+  assert_near(a / b, Vector(-0.25f, 0.4f, 6));
+  assert_near(a.min(b), Vector(-4, 2, 0.5f));
+  assert_near(a.max(b), Vector(1, 5, 3));
+  assert_near(a.normalize(), a / std::sqrt(14.f));
+  cr_assert(a == Vector(1, 2, 3));
+  cr_assert(!(a == b));
+}
+
+Test(Vector, batch_kernels) {
+  size_t count = 8 * 3 + 5;
+  std::vector<Vector> a = make_vectors(count, 0);
+  std::vector<Vector> b = make_vectors(count, 0.5f);
+  std::vector<Vector> vectors(count);
+  std::vector<float> floats(count);
+
+  batch::dot(a.data(), b.data(), floats.data(), count);
+  for (size_t i = 0; i < count; ++i) {
+    cr_assert_float_eq(floats[i], a[i] * b[i], 1e-3);
+  }
+  batch::length(a.data(), floats.data(), count);
+  for (size_t i = 0; i < count; ++i) {
+    cr_assert_float_eq(floats[i], a[i].magnitude(), 1e-4);
+  }
+  batch::cross(a.data(), b.data(), vectors.data(), count);
+  for (size_t i = 0; i < count; ++i) {
+    assert_near(vectors[i], a[i].cross(b[i]));
+  }
+  batch::normalize(a.data(), vectors.data(), count);
+  for (size_t i = 0; i < count; ++i) {
+    assert_near(vectors[i], a[i].normalize());
+  }
+  batch::min(a.data(), b.data(), vectors.data(), count);
+  for (size_t i = 0; i < count; ++i) {
+    assert_near(vectors[i], a[i].min(b[i]));
+  }
+  batch::max(a.data(), b.data(), vectors.data(), count);
+  for (size_t i = 0; i < count; ++i) {
+    assert_near(vectors[i], a[i].max(b[i]));
+  }
+}
+
+Test(Vector, batch_bounds) {
+  for (size_t count = 1; count < 12; ++count) {
+    std::vector<Vector> points = make_vectors(count, 1);
+    AABB expected(points[0], points[0]);
+    std::vector<AABB> boxes;
+
+    for (auto &point : points) {
+      expected = expected.merge(AABB(point, point));
+      boxes.emplace_back(point - Vector(1, 1, 1), point + Vector(1, 2, 3));
+    }
+    AABB box = batch::bounds(points.data(), count);
+    assert_near(box.min, expected.min);
+    assert_near(box.max, expected.max);
+
+    box = batch::merge(boxes.data(), count);
+    assert_near(box.min, expected.min - Vector(1, 1, 1));
+    assert_near(box.max, expected.max + Vector(1, 2, 3));
+    cr_assert(box.intersects(AABB(expected.max, expected.max + Vector(5, 5, 5))));
+    Vector far = expected.max + Vector(4, 0, 0);
+    cr_assert(!box.intersects(AABB(far, far + Vector(1, 1, 1))));
+  }
+}
+
+/* every count around the batches, with the outputs written over the inputs */
+Test(Vector, batch_kernels_in_place) {
+  for (size_t count = 0; count < 19; ++count) {
+    /* one past count, which the kernels must not write */
+    std::vector<Vector> a = make_vectors(count + 1, 0.2f);
+    std::vector<Vector> b = make_vectors(count + 1, 1.7f);
+    std::vector<float> lengths(count + 1, -1);
+
+    if (count > 2) {
+      /* zero and tiny vectors are left as they are by normalize */
+      a[1] = Vector(0, 0, 0);
+    }
+    std::vector<Vector> a0 = a;
+    std::vector<Vector> b0 = b;
+
+    batch::length(a.data(), lengths.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+      cr_assert_float_eq(lengths[i], a0[i].magnitude(), 1e-4);
+    }
+    cr_assert_eq(lengths[count], -1);
+
+    batch::cross(a.data(), b.data(), a.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+      assert_near(a[i], a0[i].cross(b[i]));
+    }
+    a = a0;
+    batch::normalize(a.data(), a.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+      assert_near(a[i], a0[i].normalize());
+    }
+    a = a0;
+    batch::min(a.data(), b.data(), b.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+      assert_near(b[i], a0[i].min(b0[i]));
+    }
+    cr_assert(a[count] == a0[count]);
+    cr_assert(b[count] == b0[count]);
+  }
+}
@@ -0,0 +1,131 @@
+#include <criterion/criterion.h>
+
+#include "TaskPool.hpp"
+#include "VelocityIntegrator.hpp"
+
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+using cevy::ecs::TaskPool;
+using cevy::engine::Transform;
+using cevy::engine::VelocityIntegrator;
+
+struct Bodies {
+  std::vector<Transform> transforms;
+  std::vector<Transform> velocities;
+  std::vector<float> decays;
+};
+
+static Bodies make_bodies(size_t count) {
+  Bodies bodies;
+
+  for (size_t i = 0; i < count; ++i) {
+    float f = float(i % 37);
+    Transform tm(glm::vec3(f, -f, 2), glm::quat(glm::vec3(0.1f * f, 0.3f, -0.2f)),
+                 glm::vec3(1, 2, 0.5f));
+    /* from no rotation to large ones, some past half a turn to take the shortest path */
+    Transform vel(glm::vec3(1, 0.5f * f, -3), glm::quat(glm::vec3(0.09f * f, -0.05f * f, 0)),
+                  glm::vec3(1, 1 + 0.01f * f, 0.9f));
+
+    bodies.transforms.push_back(tm);
+    bodies.velocities.push_back(vel);
+    bodies.decays.push_back(i % 3 ? 0.005f * f : 0);
+  }
+  return bodies;
+}
+
+static void assert_near(const Transform &a, const Transform &b) {
+  for (int i = 0; i < 3; ++i) {
+    cr_assert_float_eq(a.position[i], b.position[i], 1e-4);
+    cr_assert_float_eq(a.scale[i], b.scale[i], 1e-4);
+  }
+  cr_assert_float_eq(a.rotation.w, b.rotation.w, 1e-4);
+  cr_assert_float_eq(a.rotation.x, b.rotation.x, 1e-4);
+  cr_assert_float_eq(a.rotation.y, b.rotation.y, 1e-4);
+  cr_assert_float_eq(a.rotation.z, b.rotation.z, 1e-4);
+}
+
+static void integrate_and_compare(size_t count, TaskPool *pool) {
+  Bodies bodies = make_bodies(count);
+  Bodies expected = bodies;
+  VelocityIntegrator integrator;
+
+  for (size_t frame = 0; frame < 10; ++frame) {
+    float delta = frame % 2 ? 1.f / 60 : 1.f / 144;
+
+    integrator.clear();
+    for (size_t i = 0; i < count; ++i) {
+      integrator.push(bodies.transforms[i], bodies.velocities[i], bodies.decays[i]);
+      VelocityIntegrator::integrate_one(expected.transforms[i], expected.velocities[i],
+                                        expected.decays[i], delta);
+    }
+    integrator.integrate(delta, pool);
+  }
+  cr_assert_eq(integrator.size(), count);
+  for (size_t i = 0; i < count; ++i) {
+    assert_near(bodies.transforms[i], expected.transforms[i]);
+    assert_near(bodies.velocities[i], expected.velocities[i]);
+  }
+}
+
+Test(VelocityIntegrator, batches_match_scalar) {
+  integrate_and_compare(4 * VelocityIntegrator::lanes + 3, nullptr);
+}
+
+Test(VelocityIntegrator, parallel_matches_scalar) {
+  TaskPool pool(4);
+
+  integrate_and_compare(VelocityIntegrator::parallel_threshold + 5, &pool);
+}
+
+static void integrate_once_and_compare(Bodies bodies, float delta) {
+  Bodies expected = bodies;
+  VelocityIntegrator integrator;
+
+  for (size_t i = 0; i < bodies.transforms.size(); ++i) {
+    integrator.push(bodies.transforms[i], bodies.velocities[i], bodies.decays[i]);
+    VelocityIntegrator::integrate_one(expected.transforms[i], expected.velocities[i],
+                                      expected.decays[i], delta);
+  }
+  integrator.integrate(delta);
+  for (size_t i = 0; i < bodies.transforms.size(); ++i) {
+    assert_near(bodies.transforms[i], expected.transforms[i]);
+    assert_near(bodies.velocities[i], expected.velocities[i]);
+  }
+}
+
+/* the batches only take slerp factors within [0, 1], the rest goes through the scalar path */
+Test(VelocityIntegrator, delta_outside_unit) {
+  for (float delta : {-0.5f, 0.f, 1.f, 2.5f}) {
+    integrate_once_and_compare(make_bodies(2 * VelocityIntegrator::lanes + 3), delta);
+  }
+}
+
+/* a null scale stays null, and a decay of 1 stops the body, as in the scalar path */
+Test(VelocityIntegrator, zero_scale_and_full_decay) {
+  Bodies bodies = make_bodies(2 * VelocityIntegrator::lanes);
+
+  bodies.velocities[1].scale = glm::vec3(0, 1, 0.5f);
+  bodies.transforms[2].scale = glm::vec3(0, 0, 0);
+  bodies.decays[3] = 1;
+  bodies.decays[4] = 1;
+  bodies.velocities[4].scale = glm::vec3(0, 0, 2);
+  for (float delta : {0.f, 1.f / 60, 1.f}) {
+    integrate_once_and_compare(bodies, delta);
+  }
+}
+
+Test(VelocityIntegrator, without_velocity_change) {
+  VelocityIntegrator integrator;
+  std::vector<Transform> transforms(VelocityIntegrator::lanes);
+  std::vector<Transform> velocities(VelocityIntegrator::lanes);
+
+  for (size_t i = 0; i < transforms.size(); ++i) {
+    integrator.push(transforms[i], velocities[i], 0);
+  }
+  integrator.integrate(0.5f);
+  for (size_t i = 0; i < transforms.size(); ++i) {
+    assert_near(transforms[i], Transform());
+    cr_assert(velocities[i].rotation == glm::identity<glm::quat>());
+  }
+}